@@ -2,27 +2,36 @@
 #define BITBOARD_H
 
 #include "types.h"
-#include "Gamestate.h"
+#include "stateinfo.h"
 #include "move.h"
+#include "movelist.h"
 #include <vector>
 #include <cstdint>
 
 class Evaluation;
 
+// What generate() produces. Every category holds legal moves only, captures and quiets split ALL
+// in two (promotions go with whichever they are), and in check they are narrowed to evasions.
+enum GenType {
+    GEN_CAPTURES,       // captures, capture-promotions and en passant
+    GEN_QUIETS,         // everything else, including quiet promotions and castling
+    GEN_QUIET_CHECKS,   // quiet non-promotion moves giving check, empty when in check
+    GEN_EVASIONS,       // every legal move when in check, side to move must be in check
+    GEN_ALL
+};
+
 class BitBoard {
     public:
         Color sideToMove;
         int enPassantSquare = -1;
 
-        bool whiteKingsideCastle;
-        bool whiteQueensideCastle;
-        bool blackKingsideCastle;
-        bool blackQueensideCastle;
+        int castlingRights;     // CastlingRight bits
 
         int whiteKingSquare;
         int blackKingSquare;
 
         uint64_t zobristKey;
+        int halfmoveClock = 0;    // plies since the last capture or pawn move
         uint64_t repetitionPath[1024];
         int pathDepth = 0;
 
@@ -30,53 +39,74 @@ class BitBoard {
         void setStartPosition();
         void print() const;
         inline Piece getPiece(int square) const {
-            uint64_t mask = 1ULL << square;
-            if (whitePawns & mask) return WP;
-            if (blackPawns & mask) return BP;
-            if (whiteRooks & mask) return WR;
-            if (blackRooks & mask) return BR;
-            if (whiteBishops & mask) return WB;
-            if (blackBishops & mask) return BB;
-            if (whiteQueens & mask) return WQ;
-            if (blackQueens & mask) return BQ;
-            if (whiteKnights & mask) return WN;
-            if (blackKnights & mask) return BN;
-            if (whiteKing & mask) return WK;
-            if (blackKing & mask) return BK;
-            return NONE;
+            return board[square];
         }
         inline void setPiece(Piece p, int square) {
-            uint64_t mask = 1ULL << square;
             clearSquare(square);
-            switch(p) {
-                case WP: whitePawns |= mask; break;
-                case BP: blackPawns |= mask; break;
-                case WR: whiteRooks |= mask; break;
-                case BR: blackRooks |= mask; break;
-                case WB: whiteBishops |= mask; break;
-                case BB: blackBishops |= mask; break;
-                case WQ: whiteQueens |= mask; break;
-                case BQ: blackQueens |= mask; break;
-                case WN: whiteKnights |= mask; break;
-                case BN: blackKnights |= mask; break;
-                case WK: whiteKing |= mask; break;
-                case BK: blackKing |= mask; break;
-                default: break;
-            }
+            if (p == NONE) return;
+
+            uint64_t mask = 1ULL << square;
+            byType[PT_NONE] |= mask;
+            byType[typeOf(p)] |= mask;
+            byColor[colorOf(p)] |= mask;
+            board[square] = p;
         }
         bool setPositionFromFEN(const std::string& fen);
-        std::vector<Move> generateMoves() const;
-        std::vector<Move> generateCaptures() const;
+        // fills moves with the legal moves of one GenType
+        template<GenType Type> void generate(MoveList &moves) const;
         
         bool isSquareAttacked(int square, Color opponentColor) const;
+        // pieces of both colors attacking square, sliders see through nothing but occupied
+        uint64_t attackersTo(int square, uint64_t occupied) const;
+        // enemy pieces giving check to the side to move
+        inline uint64_t checkers() const { return checkersBB; }
+        // pieces of the side to move that are pinned to their own king
+        uint64_t pinnedPieces() const;
+        // static exchange evaluation of move is at least threshold
+        bool seeGE(const Move &move, int threshold = 0) const;
+
+        // move could be played here if it didn't have to care about our king, any raw value is fine
+        bool isPseudoLegal(const Move &move) const;
+        // a pseudo legal move doesn't leave our king in check
+        bool isLegal(const Move &move) const;
+
+        // move must be legal, i.e. come from generate(). The state it can't undo from the move alone
+        // goes onto the board's own stack, so unmakeMove(move) takes back the last makeMove(move).
+        void makeMove(const Move &move);
+        void unmakeMove(const Move &move);
+        // pass the turn (null move pruning), never while in check
+        void makeNullMove();
+        void unmakeNullMove();
+        // a move of the game itself: it is never taken back, so no undo record is kept and
+        // the stack only ever holds the search's own moves, however long the game gets
+        inline void makeGameMove(const Move &move) {
+            makeMove(move);
+            stateCount = 0;
+        }
 
-        bool makeMove(const Move &move);
-        void unmakeMove(const Move &move, const Gamestate &prevState);
-        bool tryMove(const Move& move);
-        
-        uint64_t getWhitePieces() const { return whitePawns | whiteRooks | whiteBishops | whiteQueens | whiteKnights | whiteKing; }
+        // zobrist key of the position after move, without making it
+        uint64_t keyAfter(const Move &move) const;
 
-        uint64_t getBlackPieces() const { return blackPawns | blackRooks | blackBishops | blackQueens | blackKnights | blackKing; }
+        // moves only carry squares, the pieces come from the board
+        inline Piece movedPiece(const Move &move) const {
+            return getPiece(move.from());
+        }
+        inline Piece capturedPiece(const Move &move) const {
+            if (move.isEnPassant()) return (sideToMove == WHITE) ? BP : WP;
+            if (move.isCastle()) return NONE;
+            return getPiece(move.to());
+        }
+        inline bool isCapture(const Move &move) const {
+            return move.isEnPassant() || (!move.isCastle() && (pieces() & (1ULL << move.to())));
+        }
+        
+        // every piece, then narrowed by color and / or piece type
+        inline uint64_t pieces() const { return byType[PT_NONE]; }
+        inline uint64_t pieces(Color c) const { return byColor[c]; }
+        inline uint64_t pieces(PieceType pt) const { return byType[pt]; }
+        inline uint64_t pieces(PieceType pt1, PieceType pt2) const { return byType[pt1] | byType[pt2]; }
+        inline uint64_t pieces(Color c, PieceType pt) const { return byColor[c] & byType[pt]; }
+        inline uint64_t pieces(Color c, PieceType pt1, PieceType pt2) const { return byColor[c] & (byType[pt1] | byType[pt2]); }
 
         inline int getLSB(uint64_t bb) const {
             return __builtin_ctzll(bb);
@@ -90,38 +120,6 @@ class BitBoard {
 
         friend class Evaluation;
 
-        inline uint64_t getWhitePawns() const {
-            return whitePawns;
-        }
-        inline uint64_t getWhiteBishops() const {
-            return whiteBishops;
-        }
-        inline uint64_t getWhiteRooks() const {
-            return whiteRooks;
-        }
-        inline uint64_t getBlackPawns() const {
-            return blackPawns;
-        }
-        inline uint64_t getBlackBishops() const {
-            return blackBishops;
-        }
-        inline uint64_t getBlackRooks() const {
-            return blackRooks;
-        }
-        inline uint64_t getWhiteQueens() const {
-            return whiteQueens;
-        }
-        inline uint64_t getBlackQueens() const {
-            return blackQueens;
-        }
-        inline uint64_t getWhiteKnights() const {
-            return whiteKnights;
-        }
-        inline uint64_t getBlackKnights() const {
-            return blackKnights;
-        }
-        inline uint64_t getAllPieces() const { return getWhitePieces() | getBlackPieces(); }
-
         // Bitboard utility functions
         uint64_t getRookAttacks(int square, uint64_t occupied) const;
         uint64_t getBishopAttacks(int square, uint64_t occupied) const;
@@ -132,37 +130,51 @@ class BitBoard {
         
 
     private:
-        uint64_t whitePawns, blackPawns;
-        uint64_t whiteRooks, blackRooks;
-        uint64_t whiteBishops, blackBishops;
-        uint64_t whiteQueens, blackQueens;
-        uint64_t whiteKnights, blackKnights;
-        uint64_t whiteKing, blackKing;
+        uint64_t byType[7];     // [PieceType], byType[PT_NONE] is the occupancy of both colors
+        uint64_t byColor[2];
+
+        // the piece on every square, kept in step with the bitboards by setPiece / clearSquare
+        Piece board[64];
+
+        uint64_t checkersBB = 0;
+
+        // undo records, one per search move on the board (game moves keep none), so search depth bounds it
+        static constexpr int MAX_STATES = 1024;
+        StateInfo states[MAX_STATES];
+        int stateCount = 0;
 
-        
-        
         inline void clearSquare(int square) {
+            Piece p = board[square];
+            if (p == NONE) return;
+
             uint64_t mask = ~(1ULL << square);
-            whitePawns &= mask;
-            blackPawns &= mask;
-            whiteRooks &= mask;
-            blackRooks &= mask;
-            whiteBishops &= mask;
-            blackBishops &= mask;
-            whiteQueens &= mask;
-            blackQueens &= mask;
-            whiteKnights &= mask;
-            blackKnights &= mask;
-            whiteKing &= mask;
-            blackKing &= mask;
+            byType[PT_NONE] &= mask;
+            byType[typeOf(p)] &= mask;
+            byColor[colorOf(p)] &= mask;
+            board[square] = NONE;
         }
 
-        void generatePawnMoves(int square, std::vector<Move>& moves, Piece p, Color color) const;
-        void generateRookMoves(int square, std::vector<Move>& moves, Piece p, Color color) const;
-        void generateBishopMoves(int square, std::vector<Move>& moves, Piece p, Color color) const;
-        void generateQueenMoves(int square, std::vector<Move>& moves, Piece p, Color color) const;
-        void generateKingMoves(int square, std::vector<Move>& moves, Piece p, Color color) const;
-        void generateKnightMoves(int square, std::vector<Move>& moves, Piece p, Color color) const;
+        void clearBoard();
+
+        // per node data shared by the generators
+        struct GenContext {
+            uint64_t target;        // squares the moves may land on
+            uint64_t pinned;        // our pieces pinned to our king
+            uint64_t discoverers;   // our pieces in front of our slider aimed at their king (GEN_QUIET_CHECKS)
+            int kingSquare;
+            int theirKingSquare;
+        };
+
+        uint64_t computeCheckers() const;
+        uint64_t sliderBlockers(int kingSquare, uint64_t rookSliders, uint64_t bishopSliders) const;
+        bool isEnPassantLegal(int from) const;
+
+        template<Color Us, GenType Type> void generateAll(MoveList& moves) const;
+        template<Color Us, GenType Type> void generateEvasions(MoveList& moves, uint64_t checkMask) const;
+        template<Color Us, GenType Type> void generatePawnMoves(MoveList& moves, const GenContext &ctx) const;
+        template<Color Us, GenType Type, PieceType Pt> void generatePieceMoves(MoveList& moves, const GenContext &ctx) const;
+        template<Color Us, GenType Type> void generateKingMoves(MoveList& moves, const GenContext &ctx) const;
+        template<Color Us> void generateCastling(MoveList& moves) const;
         
         
 };
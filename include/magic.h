@@ -18,7 +18,39 @@ extern uint64_t rookMasks[64];
 extern uint64_t bishopAttackTable[64][4096];
 extern uint64_t rookAttackTable[64][4096];
 
+// PEXT needs BMI2, which only x86 has
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define IRONFANG_PEXT 1
+#endif
+
+// Built for a CPU with BMI2 (e.g. -march=native on one): PEXT is used unconditionally and
+// inlines into the callers. Zen 1/2 targets are left out, their PEXT is microcoded and slow.
+#if defined(IRONFANG_PEXT) && defined(__BMI2__) && !defined(__znver1__) && !defined(__znver2__)
+#define IRONFANG_PEXT_DIRECT 1
+#endif
+
+#ifdef IRONFANG_PEXT
+// start of each square's slice of the dense PEXT tables
+extern uint64_t *rookPextAttacks[64];
+extern uint64_t *bishopPextAttacks[64];
+#endif
+
+// Fills the slider tables for whichever lookup this build and CPU get: PEXT on x86 with BMI2,
+// multiply-shift magics everywhere else. Unless BMI2 is known at compile time, one binary
+// picks at startup.
 void initMagicTables();
 
-uint64_t getRookAttacks(int square, uint64_t occupancy);
-uint64_t getBishopAttacks(int square, uint64_t occupancy);
+#ifdef IRONFANG_PEXT_DIRECT
+inline uint64_t getRookAttacks(int square, uint64_t occupancy) {
+    return rookPextAttacks[square][_pext_u64(occupancy, rookMasks[square])];
+}
+
+inline uint64_t getBishopAttacks(int square, uint64_t occupancy) {
+    return bishopPextAttacks[square][_pext_u64(occupancy, bishopMasks[square])];
+}
+#else
+// point at the lookup initMagicTables() picked
+extern uint64_t (*getRookAttacks)(int square, uint64_t occupancy);
+extern uint64_t (*getBishopAttacks)(int square, uint64_t occupancy);
+#endif
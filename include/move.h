@@ -2,34 +2,58 @@
 #define MOVE_H
 #include <string>
 #include <iostream>
+#include <cstdint>
 #include "types.h"
 
-class Board;
 class BitBoard;
 
-struct Move
+enum MoveType {
+    MT_NORMAL     = 0,
+    MT_PROMOTION  = 1,
+    MT_EN_PASSANT = 2,
+    MT_CASTLING   = 3
+};
+
+// 16 bits: from (0-5) | to (6-11) | promotion piece type - PT_KNIGHT (12-13) | MoveType (14-15)
+// The moving and captured pieces are not stored, ask the board (BitBoard::movedPiece/capturedPiece).
+// For castling, from/to are the king's squares. The all zero move (a8a8) is Move::none().
+class Move
 {
-    Piece piece;
+    public:
+        // left uninitialised so a MoveList costs nothing to set up, use Move::none() for "no move"
+        Move() = default;
+        constexpr explicit Move(uint16_t raw) : data(raw) {}
+        constexpr Move(int from, int to, MoveType type = MT_NORMAL, PieceType promotion = PT_KNIGHT)
+            : data(static_cast<uint16_t>(from | (to << 6) | ((promotion - PT_KNIGHT) << 12) | (type << 14))) {}
+
+        constexpr int from() const { return data & 63; }
+        constexpr int to() const { return (data >> 6) & 63; }
+        constexpr MoveType type() const { return static_cast<MoveType>(data >> 14); }
 
-    int from;
-    int to;
-    int promotion = 0;
-    int capture = 0;
-    bool isKingSideCastle = false;
-    bool isQueenSideCastle = false;
-    bool isEnPassant = false;
+        // only meaningful for MT_PROMOTION
+        constexpr PieceType promotionType() const { return static_cast<PieceType>(((data >> 12) & 3) + PT_KNIGHT); }
 
-    int heuristicScore = 0;
+        constexpr bool isPromotion() const { return type() == MT_PROMOTION; }
+        constexpr bool isEnPassant() const { return type() == MT_EN_PASSANT; }
+        constexpr bool isCastle() const { return type() == MT_CASTLING; }
+        constexpr bool isKingSideCastle() const { return isCastle() && to() > from(); }
+        constexpr bool isQueenSideCastle() const { return isCastle() && to() < from(); }
 
-    Move() {};
+        static constexpr Move none() { return Move(uint16_t(0)); }
+        constexpr bool isNone() const { return data == 0; }
+        constexpr uint16_t raw() const { return data; }
 
-    Move(Piece p, int from, int to, int promotion = 0, int capture = 0, bool isKingSideCastle = false, bool isQueenSideCastle = false, bool isEnPassant = false) : piece(p), from(from), to(to), promotion(promotion), capture(capture), isKingSideCastle(isKingSideCastle), isQueenSideCastle(isQueenSideCastle), isEnPassant(isEnPassant) {};
+        constexpr bool operator==(const Move &other) const { return data == other.data; }
+        constexpr bool operator!=(const Move &other) const { return data != other.data; }
+
+    private:
+        uint16_t data;
 };
 
-std::string moveToAlgrebraic(Move move);
+static_assert(sizeof(Move) == 2, "Move is expected to be 16 bits");
+
+std::string moveToAlgrebraic(Move move, const BitBoard &board);
 std::string moveToUCI(Move move);
 Move uciToMove(const std::string& uci, BitBoard &board);
 std::ostream& operator<<(std::ostream& os, const Move &move);
-bool operator==(const Move &lhs, const Move &rhs);
-bool operator!=(const Move &lhs, const Move &rhs);
-#endif
\ No newline at end of file
+#endif
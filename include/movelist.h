@@ -0,0 +1,50 @@
+#ifndef MOVELIST_H
+#define MOVELIST_H
+
+#include "move.h"
+#include <cassert>
+#include <utility>
+
+// no legal chess position has more than 218 moves
+constexpr int MAX_MOVES = 256;
+
+// Fixed capacity move list that lives on the stack, the generators fill it in place.
+// scores[] is left uninitialised, it is only meaningful once the caller has scored the moves.
+struct MoveList {
+    Move moves[MAX_MOVES];
+    int scores[MAX_MOVES];
+    int count = 0;
+
+    inline void push_back(Move move) {
+        assert(count < MAX_MOVES);
+        moves[count++] = move;
+    }
+
+    inline int size() const { return count; }
+    inline bool empty() const { return count == 0; }
+    inline void clear() { count = 0; }
+
+    inline Move &operator[](int i) { return moves[i]; }
+    inline const Move &operator[](int i) const { return moves[i]; }
+
+    inline Move *begin() { return moves; }
+    inline Move *end() { return moves + count; }
+    inline const Move *begin() const { return moves; }
+    inline const Move *end() const { return moves + count; }
+
+    // selection sort step: brings the best scored move of [i, count) to i and returns it,
+    // so a cutoff early in the list never pays for sorting the rest
+    inline Move pickBest(int i) {
+        int best = i;
+        for (int j = i + 1; j < count; ++j) {
+            if (scores[j] > scores[best]) best = j;
+        }
+        if (best != i) {
+            std::swap(moves[i], moves[best]);
+            std::swap(scores[i], scores[best]);
+        }
+        return moves[i];
+    }
+};
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef MOVEPICKER_H
+#define MOVEPICKER_H
+
+#include "bitboard.h"
+#include "movelist.h"
+#include <array>
+
+using HistoryTable = std::array<std::array<int, 64>, 64>; // [from][to]
+
+// Hands out the moves of a node one at a time, best guess first, and only generates or sorts a
+// group of moves once the search actually gets to it. Main search order:
+//   TT move, captures that don't lose material (MVV-LVA), killers, quiets by history, losing captures.
+// In check it is the TT move then all evasions. In quiescence the TT move then captures (or evasions).
+class MovePicker {
+    public:
+        // main search
+        MovePicker(const BitBoard &board, Move ttMove, const Move *killers, const HistoryTable &history, bool inCheck);
+        // quiescence
+        MovePicker(const BitBoard &board, Move ttMove, const HistoryTable &history, bool inCheck);
+
+        // Move::none() once every move has been handed out
+        Move next();
+
+    private:
+        enum Stage {
+            MAIN_TT, CAPTURE_INIT, GOOD_CAPTURES, KILLER_1, KILLER_2, QUIET_INIT, QUIETS, BAD_CAPTURES,
+            EVASION_TT, EVASION_INIT, EVASIONS,
+            QSEARCH_TT, QCAPTURE_INIT, QCAPTURES,
+            DONE
+        };
+
+        bool isValid(Move move) const;
+        void scoreCaptures();
+        void scoreQuiets();
+        void scoreEvasions();
+
+        const BitBoard &board;
+        const HistoryTable &history;
+        Move ttMove;
+        Move killers[2];
+        int stage;
+
+        MoveList moves;        // captures or evasions
+        MoveList quiets;
+        int current = 0;
+        int badCaptures = 0;   // losing captures are parked at moves[0, badCaptures)
+};
+
+#endif
@@ -1,7 +1,6 @@
 #ifndef SEARCH_H
 #define SEARCH_H
 
-#include "board.h"
 #include "bitboard.h"
 
 constexpr int INF = 1000000;                    // General infinity value
@@ -0,0 +1,18 @@
+#ifndef STATEINFO_H
+#define STATEINFO_H
+
+#include "types.h"
+#include <cstdint>
+
+// Everything makeMove throws away that can't be worked out backwards from the move. makeMove pushes
+// one onto the board's own stack and unmakeMove pops it, so callers never snapshot the position.
+struct StateInfo {
+    uint64_t zobristKey;
+    uint64_t checkers;
+    int enPassantSquare;
+    int halfmoveClock;
+    int castlingRights;
+    Piece capturedPiece;
+};
+
+#endif
@@ -1,9 +1,28 @@
 #pragma once
 #include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <string>
 #include "move.h"
 
-constexpr size_t TT_SIZE = 1 << 23; // 2^23
-constexpr size_t TT_MASK = TT_SIZE  - 1;
+constexpr size_t TT_DEFAULT_MB = 64;
+constexpr size_t TT_MIN_MB = 1;
+constexpr size_t TT_MAX_MB = 65536;
+constexpr int TT_MAX_CLEAR_THREADS = 256;
+
+constexpr int TT_EVAL_NONE = INT16_MIN; // no static eval stored
+constexpr int TT_GENERATION_MASK = 63;  // generation gets the 6 bits above the bound
+
+// where the table memory came from
+enum TT_BACKING {
+    TT_BACKING_NONE,
+    TT_BACKING_HEAP,        // plain new[]
+    TT_BACKING_MMAP,        // anonymous mmap, huge pages unavailable
+    TT_BACKING_THP,         // anonymous mmap + madvise(MADV_HUGEPAGE)
+    TT_BACKING_HUGETLB,     // mmap(MAP_HUGETLB), explicitly reserved huge pages
+    TT_BACKING_FILE,        // private (copy-on-write) mapping of a saved table
+    TT_BACKING_SHARED,      // named POSIX shared memory, shared with other processes
+};
 
 enum TT_FLAG  { 
     TT_EXACT,
@@ -11,27 +30,107 @@ enum TT_FLAG  {
     TT_LOWER,
 };
 
+// Payload of an entry, packed into a single 64-bit word
+struct TTData {
+    uint16_t move;       // Move::raw(), 0 = no move
+    int16_t  eval;       // search score, see encodeScore() in tt.cpp
+    int16_t  staticEval; // TT_EVAL_NONE if unknown
+    int8_t   depth;      // negative for quiescence entries
+    uint8_t  genBound;   // generation << 2 | TT_FLAG
+
+    inline TT_FLAG flag() const { return static_cast<TT_FLAG>(genBound & 3); }
+    inline int generation() const { return genBound >> 2; }
+
+    inline uint64_t pack() const {
+        return  static_cast<uint64_t>(move)
+             | (static_cast<uint64_t>(static_cast<uint16_t>(eval))       << 16)
+             | (static_cast<uint64_t>(static_cast<uint16_t>(staticEval)) << 32)
+             | (static_cast<uint64_t>(static_cast<uint8_t>(depth))       << 48)
+             | (static_cast<uint64_t>(genBound)                          << 56);
+    }
+
+    static inline TTData unpack(uint64_t word) {
+        return TTData{
+            static_cast<uint16_t>(word),
+            static_cast<int16_t>(word >> 16),
+            static_cast<int16_t>(word >> 32),
+            static_cast<int8_t>(word >> 48),
+            static_cast<uint8_t>(word >> 56)
+        };
+    }
+};
+
+// 16 bytes, lockless: the key is stored XORed with the data word. Both words are
+// written separately, so a probe racing with a store (or two racing stores) can see
+// halves of different entries; the XOR then no longer yields the probed key and the
+// entry is simply treated as a miss. An empty entry is all zero.
 struct TTEntry {
-    uint64_t key;
-    int depth;
-    int eval;
-    TT_FLAG flag;
-    Move bestMove;
-    int age;
+    std::atomic<uint64_t> keyXorData;
+    std::atomic<uint64_t> data;
+
+    inline uint64_t key(uint64_t dataWord) const {
+        return keyXorData.load(std::memory_order_relaxed) ^ dataWord;
+    }
+    inline uint64_t loadData() const {
+        return data.load(std::memory_order_relaxed);
+    }
+    inline void write(uint64_t zobristKey, uint64_t dataWord) {
+        data.store(dataWord, std::memory_order_relaxed);
+        keyXorData.store(zobristKey ^ dataWord, std::memory_order_relaxed);
+    }
 };
 
+static_assert(sizeof(TTEntry) == 16, "TTEntry is expected to be 16 bytes");
+
+constexpr int TT_CLUSTER_SIZE = 4;
+
+// one cache line worth of entries sharing the same index
+struct alignas(64) TTCluster {
+    TTEntry entries[TT_CLUSTER_SIZE];
+};
+
+static_assert(sizeof(TTCluster) == 64, "TTCluster is expected to fill one cache line");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "TT entries rely on lock-free 64-bit atomics");
+
+// Per-thread counters, only touched while TranspositionTable::statsEnabled is set
+struct TTStats {
+    uint64_t probes = 0;
+    uint64_t keyMatches = 0;
+    uint64_t cutoffs[3] = {};     // indexed by TT_FLAG
+    uint64_t collisions = 0;      // missed, and the cluster was full of other positions
+    uint64_t verifyFailures = 0;  // slot whose key failed verification (torn write)
+    uint64_t stores = 0;
+    uint64_t replacements = 0;    // stores that evicted another position
+};
+
+extern thread_local TTStats ttStats;
+
 class TranspositionTable {
     public:
         TranspositionTable();
-        ~TranspositionTable() = default;
+        ~TranspositionTable();
+
+        TranspositionTable(const TranspositionTable&) = delete;
+        TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+        // frees the current table and allocates a cleared one of (at most) the given size.
+        // While shared, re-attaches to the shared segment instead.
+        void resize(size_t megabytes);
 
+        // Back the table with the named shared memory segment (created with the current
+        // Hash size if it doesn't exist yet), or go back to a private table for an empty name.
+        bool setShared(const std::string &name, std::string &error);
+        bool isShared() const { return tableBacking == TT_BACKING_SHARED; }
+
+        // outMove and outStaticEval are filled on any key match, even if the probe fails
         bool probe(
             uint64_t zobristKey,
             int depth,
             int alpha,
             int beta,
             int &outEval,
-            Move &outMove
+            Move &outMove,
+            int *outStaticEval = nullptr
         );
 
         void store(
@@ -39,23 +138,63 @@ class TranspositionTable {
             int depth,
             int eval,
             TT_FLAG flag,
-            const Move &bestMove
+            const Move &bestMove,
+            int staticEval = TT_EVAL_NONE
         );
 
+        // pull the cluster for zobristKey towards the cache ahead of a probe
+        inline void prefetch(uint64_t zobristKey) const {
+            __builtin_prefetch(&table[zobristKey & mask]);
+        }
+
+        // zeroes the table, split over clearThreads threads that each own a contiguous
+        // slice (so on a fresh table the pages are also first touched by that thread)
         void clear();
-        uint64_t lookupCount = 0; 
-        uint64_t hitCount    = 0;
-        uint64_t keyMatchCount   = 0;
-        size_t totalStoreAttempts = 0;
-        size_t actualStores = 0;
-        size_t overwritten = 0;
-        size_t entriesOccupied = 0;
+
+        // Persist the table to disk, and map a saved table back in place of the current one.
+        // Both return false and fill error if the file can't be used.
+        bool save(const std::string &path, std::string &error) const;
+        bool load(const std::string &path, std::string &error);
+
+        int clearThreads = 1;
+        double lastClearMs = 0;
+        int lastClearThreadsUsed = 0;
         int currentAge;
 
+        // starts a new generation: entries of earlier searches become the first to be replaced.
+        // While shared the generation is the segment's, advanced by whichever process searches.
+        void newSearch();
+        inline int currentGeneration() const {
+            int age = sharedGeneration ? sharedGeneration->load(std::memory_order_relaxed) : currentAge;
+            return age & TT_GENERATION_MASK;
+        }
+
+        // set by "debug on" / the TT Stats option, fills ttStats on every probe and store
+        static bool statsEnabled;
+
         size_t countOccupied() const;
         int hashfull() const;
 
+        size_t size() const { return numClusters * TT_CLUSTER_SIZE; }
+        size_t sizeMB() const { return (numClusters * sizeof(TTCluster)) >> 20; }
+        TT_BACKING backing() const { return tableBacking; }
+        const char *backingName() const;
+
     private:
-        TTEntry table[TT_SIZE];
+        bool allocate(size_t clusters);
+        bool attachShared(const std::string &name, std::string &error);
+        void release();
+
+        size_t configuredMB = TT_DEFAULT_MB;
+        std::string sharedName;
+
+        TTCluster *table = nullptr;
+        std::atomic<int32_t> *sharedGeneration = nullptr; // in the segment header while shared
+        TT_BACKING tableBacking = TT_BACKING_NONE;
+        void *mapBase = nullptr; // start and length of the mapping when mmap backed
+        size_t mapBytes = 0;
+        size_t numClusters = 0; // always a power of two
+        size_t mask = 0;
 };
-    
\ No newline at end of file
+
+extern TranspositionTable TT;
@@ -2,7 +2,7 @@
 #define TYPES_H
 
 
-// Piece % 8 = Base Piece Type (1 = Pawn, 2 = Rook, 3 = Knight, 4 = Bishop, 5 = Queen, 6 = King)
+// Piece % 8 = Base Piece Type (1 = Pawn, 2 = Knight, 3 = Bishop, 4 = Rook, 5 = Queen, 6 = King)
 enum Piece {
     NONE,
     WP = 1, WN, WB, WR, WQ, WK,
@@ -20,6 +20,16 @@ enum PieceType {
 };
 
 
+// one bit per castling right, a position's rights are any combination of them (0-15)
+enum CastlingRight {
+    NO_CASTLING     = 0,
+    WHITE_KINGSIDE  = 1,
+    WHITE_QUEENSIDE = 2,
+    BLACK_KINGSIDE  = 4,
+    BLACK_QUEENSIDE = 8,
+    ALL_CASTLING    = 15
+};
+
 enum Color {
     WHITE,
     BLACK,
@@ -42,6 +52,24 @@ inline Color getPieceColor(Piece p) {
     return NO_COLOR;
 }
 
+inline PieceType typeOf(Piece p) {
+    return static_cast<PieceType>(p & 7);
+}
+
+// p must not be NONE
+inline Color colorOf(Piece p) {
+    return static_cast<Color>(p >> 3);
+}
+
+// the other side
+constexpr Color operator~(Color c) {
+    return static_cast<Color>(c ^ BLACK);
+}
+
+inline Piece makePiece(Color c, PieceType pt) {
+    return static_cast<Piece>(pt | (c << 3));
+}
+
 inline char pieceToChar(Piece p) {
     switch(p) {
         case WP: return 'P';
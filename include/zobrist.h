@@ -1,16 +1,18 @@
 #pragma once
 #include <cstdint>
 #include "types.h"
-#include "board.h"
 #include "bitboard.h"
 
 extern uint64_t zobristPieces[12][64]; // 12 Piece types - 64 possible squares for each
-extern uint64_t zobristCastling[4]; // KQkq
+extern uint64_t zobristCastling[16]; // one key per castling rights mask
 extern uint64_t zobristEnPassant[8]; // a-h
 extern uint64_t zobristBlackToMove;
 
+constexpr uint64_t ZOBRIST_SEED = 1337;
+
 void initZobrist();
-uint64_t generateZobristHashKey(Board &b);
+// folds every zobrist key into one value, so data keyed by them (e.g. a saved TT) can be checked
+uint64_t zobristFingerprint();
 uint64_t generateZobristHashKey(BitBoard &b);
 
 inline int pieceToZobristIndex(Piece p) {
@@ -1,19 +1,36 @@
 #include "bitboard.h"
 #include "zobrist.h"
 #include "magic.h"
+#include "evaluate.h"
 #include<iostream>
 #include <sstream>
 #include <string>
 #include <cctype>
 #include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <iterator>
 
 // Precomputed attack tables
 static uint64_t knightAttacks[64];
 static uint64_t kingAttacks[64];
 static uint64_t pawnAttacks[2][64]; // [color][square]
+static uint64_t betweenBB[64][64];   // squares strictly between two aligned squares
+static uint64_t lineBB[64][64];      // the whole line through two aligned squares
 
+// Castling rights kept when a move starts or ends on a square: a king or rook leaving home,
+// or a rook captured there, drops the rights that need it. Every other square keeps them all.
+static int castlingMask[64];
 
 void initAttackTables() {
+    for (int sq = 0; sq < 64; ++sq) castlingMask[sq] = ALL_CASTLING;
+    castlingMask[60] &= ~(WHITE_KINGSIDE | WHITE_QUEENSIDE); // e1
+    castlingMask[63] &= ~WHITE_KINGSIDE;                     // h1
+    castlingMask[56] &= ~WHITE_QUEENSIDE;                    // a1
+    castlingMask[4]  &= ~(BLACK_KINGSIDE | BLACK_QUEENSIDE); // e8
+    castlingMask[7]  &= ~BLACK_KINGSIDE;                     // h8
+    castlingMask[0]  &= ~BLACK_QUEENSIDE;                    // a8
+
     // Initialize knight attacks
     for (int sq = 0; sq < 64; ++sq) {
         uint64_t attacks = 0ULL;
@@ -62,6 +79,23 @@ void initAttackTables() {
             if (file < 7) pawnAttacks[BLACK][sq] |= 1ULL << ((rank+1) * 8 + file+1);
         }
     }
+
+    // Initialize between / line masks (the slow ray walkers, the magic tables aren't built yet)
+    for (int s1 = 0; s1 < 64; ++s1) {
+        for (int s2 = 0; s2 < 64; ++s2) {
+            uint64_t b1 = 1ULL << s1, b2 = 1ULL << s2;
+            if (s1 == s2) continue;
+
+            if (rook_attacks(s1, 0) & b2) {
+                lineBB[s1][s2] = (rook_attacks(s1, 0) & rook_attacks(s2, 0)) | b1 | b2;
+                betweenBB[s1][s2] = rook_attacks(s1, b2) & rook_attacks(s2, b1);
+            }
+            else if (bishop_attacks(s1, 0) & b2) {
+                lineBB[s1][s2] = (bishop_attacks(s1, 0) & bishop_attacks(s2, 0)) | b1 | b2;
+                betweenBB[s1][s2] = bishop_attacks(s1, b2) & bishop_attacks(s2, b1);
+            }
+        }
+    }
 }
 
 BitBoard::BitBoard() {
@@ -75,39 +109,37 @@ BitBoard::BitBoard() {
     setStartPosition();
 }
 
+void BitBoard::clearBoard() {
+    std::fill(std::begin(byType), std::end(byType), 0);
+    std::fill(std::begin(byColor), std::end(byColor), 0);
+    std::fill(std::begin(board), std::end(board), NONE);
+
+    // a new position has nothing to take back
+    stateCount = 0;
+}
+
 void BitBoard::setStartPosition() {
-    // Clear all bitboards
-    whitePawns = blackPawns = 0;
-    whiteRooks = blackRooks = 0;
-    whiteBishops = blackBishops = 0;
-    whiteQueens = blackQueens = 0;
-    whiteKnights = blackKnights = 0;
-    whiteKing = blackKing = 0;
+    clearBoard();
 
     // Set starting position
-    whiteRooks = 0x8100000000000000ULL;    // a1, h1
-    whiteKnights = 0x4200000000000000ULL;  // b1, g1
-    whiteBishops = 0x2400000000000000ULL;  // c1, f1
-    whiteQueens = 0x0800000000000000ULL;   // d1
-    whiteKing = 0x1000000000000000ULL;     // e1
-    whitePawns = 0x00FF000000000000ULL;    // rank 2
-
-    blackRooks = 0x0000000000000081ULL;    // a8, h8
-    blackKnights = 0x0000000000000042ULL;  // b8, g8
-    blackBishops = 0x0000000000000024ULL;  // c8, f8
-    blackQueens = 0x0000000000000008ULL;   // d8
-    blackKing = 0x0000000000000010ULL;     // e8
-    blackPawns = 0x000000000000FF00ULL;    // rank 7
+    static constexpr PieceType backRank[8] = {PT_ROOK, PT_KNIGHT, PT_BISHOP, PT_QUEEN, PT_KING, PT_BISHOP, PT_KNIGHT, PT_ROOK};
+    for (int file = 0; file < 8; ++file) {
+        setPiece(makePiece(BLACK, backRank[file]), file);
+        setPiece(BP, 8 + file);
+        setPiece(WP, 48 + file);
+        setPiece(makePiece(WHITE, backRank[file]), 56 + file);
+    }
 
     sideToMove = WHITE;
-    whiteKingsideCastle = true;
-    whiteQueensideCastle = true;
-    blackKingsideCastle = true;
-    blackQueensideCastle = true;
+    castlingRights = ALL_CASTLING;
 
     whiteKingSquare = 60; // e1
     blackKingSquare = 4;  // e8
 
+    enPassantSquare = -1;
+    halfmoveClock = 0;
+    checkersBB = 0;
+
     zobristKey = generateZobristHashKey(*this);
 }
 
@@ -116,11 +148,11 @@ void BitBoard::setStartPosition() {
 
 
 uint64_t BitBoard::getRookAttacks(int square, uint64_t occupied) const {
-    return ::getRookAttacks(square, occupied); // use magic-based version
+    return ::getRookAttacks(square, occupied); // PEXT or magic lookup, see magic.h
 }
 
 uint64_t BitBoard::getBishopAttacks(int square, uint64_t occupied) const {
-    return ::getBishopAttacks(square, occupied); // use magic-based version
+    return ::getBishopAttacks(square, occupied); // PEXT or magic lookup, see magic.h
 }
 
 uint64_t BitBoard::getQueenAttacks(int square, uint64_t occupied) const {
@@ -140,371 +172,602 @@ uint64_t BitBoard::getPawnAttacks(int square, Color color) const {
 }
 
 bool BitBoard::isSquareAttacked(int square, Color opponentColor) const {
-    uint64_t occupied = getAllPieces();
+    uint64_t occupied = pieces();
     
     // Check pawn attacks
-    uint64_t opponentPawns = (opponentColor == WHITE) ? whitePawns : blackPawns;
-    if (getPawnAttacks(square, static_cast<Color>(1 - opponentColor)) & opponentPawns) return true;
+    if (getPawnAttacks(square, ~opponentColor) & pieces(opponentColor, PT_PAWN)) return true;
     
     // Check knight attacks
-    uint64_t opponentKnights = (opponentColor == WHITE) ? whiteKnights : blackKnights;
-    if (getKnightAttacks(square) & opponentKnights) return true;
+    if (getKnightAttacks(square) & pieces(opponentColor, PT_KNIGHT)) return true;
     
     // Check bishop/queen attacks
-    uint64_t opponentBishops = (opponentColor == WHITE) ? (whiteBishops | whiteQueens) : (blackBishops | blackQueens);
-    if (getBishopAttacks(square, occupied) & opponentBishops) return true;
+    if (getBishopAttacks(square, occupied) & pieces(opponentColor, PT_BISHOP, PT_QUEEN)) return true;
     
     // Check rook/queen attacks
-    uint64_t opponentRooks = (opponentColor == WHITE) ? (whiteRooks | whiteQueens) : (blackRooks | blackQueens);
-    if (getRookAttacks(square, occupied) & opponentRooks) return true;
+    if (getRookAttacks(square, occupied) & pieces(opponentColor, PT_ROOK, PT_QUEEN)) return true;
     
     // Check king attacks
-    uint64_t opponentKing = (opponentColor == WHITE) ? whiteKing : blackKing;
-    if (getKingAttacks(square) & opponentKing) return true;
+    if (getKingAttacks(square) & pieces(opponentColor, PT_KING)) return true;
     
     return false;
 }
 
-std::vector<Move> BitBoard::generateMoves() const {
-    std::vector<Move> moves;
-    moves.reserve(218);
-    
-    uint64_t pieces = (sideToMove == WHITE) ? getWhitePieces() : getBlackPieces();
-    
-    while (pieces) {
-        int square = popLSB(pieces);
-        Piece piece = getPiece(square);
-        
-        switch (piece) {
-            case WP: case BP:
-                generatePawnMoves(square, moves, piece, sideToMove);
-                break;
-            case WR: case BR:
-                generateRookMoves(square, moves, piece, sideToMove);
-                break;
-            case WB: case BB:
-                generateBishopMoves(square, moves, piece, sideToMove);
-                break;
-            case WQ: case BQ:
-                generateQueenMoves(square, moves, piece, sideToMove);
-                break;
-            case WK: case BK:
-                generateKingMoves(square, moves, piece, sideToMove);
-                break;
-            case WN: case BN:
-                generateKnightMoves(square, moves, piece, sideToMove);
-                break;
-            default:
-                break;
+uint64_t BitBoard::attackersTo(int square, uint64_t occupied) const {
+    return (getPawnAttacks(square, BLACK) & pieces(WHITE, PT_PAWN))
+         | (getPawnAttacks(square, WHITE) & pieces(BLACK, PT_PAWN))
+         | (getKnightAttacks(square) & pieces(PT_KNIGHT))
+         | (getBishopAttacks(square, occupied) & pieces(PT_BISHOP, PT_QUEEN))
+         | (getRookAttacks(square, occupied) & pieces(PT_ROOK, PT_QUEEN))
+         | (getKingAttacks(square) & pieces(PT_KING));
+}
+
+// Static exchange evaluation: does the exchange sequence on move.to() that starts with move win at
+// least threshold for the side to move? Both sides always recapture with their least valuable
+// attacker and may stop whenever that is better, sliders behind the recapturing piece join in
+// (x-rays). Pins are ignored. Special moves (castling, en passant, promotions) are scored as 0.
+bool BitBoard::seeGE(const Move &move, int threshold) const {
+    const int *value = Evaluation::pieceValue;
+
+    if (move.type() != MT_NORMAL) return 0 >= threshold;
+
+    int from = move.from(), to = move.to();
+
+    // what we win if they don't recapture, then what we lose if they do and we stop
+    int swap = value[getPiece(to) & 7] - threshold;
+    if (swap < 0) return false;
+
+    swap = value[getPiece(from) & 7] - swap;
+    if (swap <= 0) return true;
+
+    uint64_t occupied = pieces() ^ (1ULL << from) ^ (1ULL << to);
+    uint64_t attackers = attackersTo(to, occupied);
+    uint64_t diagonal = pieces(PT_BISHOP, PT_QUEEN);
+    uint64_t straight = pieces(PT_ROOK, PT_QUEEN);
+    Color stm = sideToMove;
+    bool result = true;
+
+    while (true) {
+        stm = ~stm;
+        attackers &= occupied;
+
+        uint64_t stmAttackers = attackers & pieces(stm);
+        if (!stmAttackers) break;
+
+        result = !result;
+
+        uint64_t bb;
+        if ((bb = stmAttackers & pieces(PT_PAWN))) {
+            if ((swap = value[PT_PAWN] - swap) < result) break;
+            occupied ^= bb & -bb;
+            attackers |= getBishopAttacks(to, occupied) & diagonal;
+        }
+        else if ((bb = stmAttackers & pieces(PT_KNIGHT))) {
+            if ((swap = value[PT_KNIGHT] - swap) < result) break;
+            occupied ^= bb & -bb;
+        }
+        else if ((bb = stmAttackers & pieces(PT_BISHOP))) {
+            if ((swap = value[PT_BISHOP] - swap) < result) break;
+            occupied ^= bb & -bb;
+            attackers |= getBishopAttacks(to, occupied) & diagonal;
+        }
+        else if ((bb = stmAttackers & pieces(PT_ROOK))) {
+            if ((swap = value[PT_ROOK] - swap) < result) break;
+            occupied ^= bb & -bb;
+            attackers |= getRookAttacks(to, occupied) & straight;
+        }
+        else if ((bb = stmAttackers & pieces(PT_QUEEN))) {
+            if ((swap = value[PT_QUEEN] - swap) < result) break;
+            occupied ^= bb & -bb;
+            attackers |= (getBishopAttacks(to, occupied) & diagonal) | (getRookAttacks(to, occupied) & straight);
+        }
+        else {
+            // the king can only take last, and not at all if the square is still defended
+            return (attackers & pieces(~stm)) ? !result : result;
         }
     }
-    
-    return moves;
+
+    return result;
 }
 
-std::vector<Move> BitBoard::generateCaptures() const
-{
-    std::vector<Move> captures;
-    captures.reserve(36);
+// worked out once per position, by makeMove or when the position is set up, checkers() just reads it
+uint64_t BitBoard::computeCheckers() const {
+    int kingSquare = (sideToMove == WHITE) ? whiteKingSquare : blackKingSquare;
+    uint64_t enemies = pieces(~sideToMove);
+    return attackersTo(kingSquare, pieces()) & enemies;
+}
 
-    Color color = sideToMove;
-    uint64_t pieces = (color == WHITE) ? getWhitePieces() : getBlackPieces();
-    uint64_t enemies = (color == WHITE) ? getBlackPieces() : getWhitePieces();
-    uint64_t occupied = getAllPieces();
-    
-    // For each piece of the side to move
-    while (pieces) {
-        int square = popLSB(pieces);
-        Piece piece = getPiece(square);
-        
-        switch (piece) {
-            case WP: case BP: {
-                // Pawn captures (including promotions and en passant)
-                int promotionRank = (color == WHITE) ? 0 : 7;
-                
-                // Regular pawn captures
-                uint64_t attacks = getPawnAttacks(square, color) & enemies;
-                
-                while (attacks) {
-                    int targetSquare = popLSB(attacks);
-                    Piece captured = getPiece(targetSquare);
-                    
-                    if (targetSquare / 8 == promotionRank) {
-                        // Promotion captures
-                        Piece baseQueen = (color == WHITE) ? WQ : BQ;
-                        Piece baseRook = (color == WHITE) ? WR : BR;
-                        Piece baseBishop = (color == WHITE) ? WB : BB;
-                        Piece baseKnight = (color == WHITE) ? WN : BN;
-                        
-                        captures.push_back(Move(piece, square, targetSquare, baseQueen, captured));
-                        captures.push_back(Move(piece, square, targetSquare, baseRook, captured));
-                        captures.push_back(Move(piece, square, targetSquare, baseBishop, captured));
-                        captures.push_back(Move(piece, square, targetSquare, baseKnight, captured));
-                    } else {
-                        captures.push_back(Move(piece, square, targetSquare, 0, captured));
-                    }
-                }
-                
-                // En passant capture
-                if (enPassantSquare != -1) {
-                    if (getPawnAttacks(square, color) & (1ULL << enPassantSquare)) {
-                        Piece capturedPawn = (color == WHITE) ? BP : WP;
-                        captures.push_back(Move(piece, square, enPassantSquare, 0, capturedPawn, false, false, true));
-                    }
-                }
-                break;
-            }
-                
-            case WR: case BR: {
-                uint64_t attacks = getRookAttacks(square, occupied) & enemies;
-                while (attacks) {
-                    int targetSquare = popLSB(attacks);
-                    Piece captured = getPiece(targetSquare);
-                    captures.push_back(Move(piece, square, targetSquare, 0, captured));
-                }
-                break;
-            }
-                
-            case WB: case BB: {
-                uint64_t attacks = getBishopAttacks(square, occupied) & enemies;
-                while (attacks) {
-                    int targetSquare = popLSB(attacks);
-                    Piece captured = getPiece(targetSquare);
-                    captures.push_back(Move(piece, square, targetSquare, 0, captured));
-                }
-                break;
-            }
-                
-            case WQ: case BQ: {
-                uint64_t attacks = getQueenAttacks(square, occupied) & enemies;
-                while (attacks) {
-                    int targetSquare = popLSB(attacks);
-                    Piece captured = getPiece(targetSquare);
-                    captures.push_back(Move(piece, square, targetSquare, 0, captured));
-                }
-                break;
+// Pieces of either color that are the only thing standing between kingSquare and one of the given
+// sliders. Ours in front of their slider are pinned, ours in front of our slider give discovered check.
+uint64_t BitBoard::sliderBlockers(int kingSquare, uint64_t rookSliders, uint64_t bishopSliders) const {
+    uint64_t occupied = pieces();
+
+    // sliders that would see the king on an empty board
+    uint64_t snipers = (getRookAttacks(kingSquare, 0) & rookSliders) | (getBishopAttacks(kingSquare, 0) & bishopSliders);
+    uint64_t blockers = 0;
+
+    while (snipers) {
+        uint64_t between = betweenBB[kingSquare][popLSB(snipers)] & occupied;
+        if (between && !(between & (between - 1))) blockers |= between;
+    }
+    return blockers;
+}
+
+uint64_t BitBoard::pinnedPieces() const {
+    Color them = ~sideToMove;
+    int kingSquare = (sideToMove == WHITE) ? whiteKingSquare : blackKingSquare;
+    return sliderBlockers(kingSquare, pieces(them, PT_ROOK, PT_QUEEN), pieces(them, PT_BISHOP, PT_QUEEN)) & pieces(sideToMove);
+}
+
+// En passant removes two pieces from the capturing rank, which the pin mask can't see
+// (e.g. king and rook on the same rank as both pawns), so it is checked by playing it on the occupancy.
+bool BitBoard::isEnPassantLegal(int from) const {
+    int kingSquare = (sideToMove == WHITE) ? whiteKingSquare : blackKingSquare;
+    int capturedPawnSquare = enPassantSquare + (sideToMove == WHITE ? 8 : -8);
+    uint64_t enemies = pieces(~sideToMove);
+
+    uint64_t occupied = (pieces() ^ (1ULL << from) ^ (1ULL << capturedPawnSquare)) | (1ULL << enPassantSquare);
+    return !(attackersTo(kingSquare, occupied) & enemies & ~(1ULL << capturedPawnSquare));
+}
+
+template<PieceType Pt>
+static inline uint64_t attacksFrom(int square, uint64_t occupied) {
+    if constexpr (Pt == PT_KNIGHT)      return knightAttacks[square];
+    else if constexpr (Pt == PT_BISHOP) return getBishopAttacks(square, occupied);
+    else if constexpr (Pt == PT_ROOK)   return getRookAttacks(square, occupied);
+    else if constexpr (Pt == PT_QUEEN)  return getBishopAttacks(square, occupied) | getRookAttacks(square, occupied);
+    else                                return kingAttacks[square];
+}
+
+// the four promotions of a pawn move, queen first
+static inline void addPromotions(MoveList& moves, int from, int to) {
+    moves.push_back(Move(from, to, MT_PROMOTION, PT_QUEEN));
+    moves.push_back(Move(from, to, MT_PROMOTION, PT_ROOK));
+    moves.push_back(Move(from, to, MT_PROMOTION, PT_BISHOP));
+    moves.push_back(Move(from, to, MT_PROMOTION, PT_KNIGHT));
+}
+
+static constexpr uint64_t FILE_A_BB = 0x0101010101010101ULL;
+static constexpr uint64_t FILE_H_BB = 0x8080808080808080ULL;
+
+// shifts a bitboard by a square offset, negative towards a8
+template<int Offset>
+static inline uint64_t shiftBB(uint64_t bb) {
+    return Offset > 0 ? bb << Offset : bb >> -Offset;
+}
+
+// All pawns at once: shift the pawn set one step forward / diagonally and pop the targets,
+// the origin is just the target minus the shift.
+template<Color Us, GenType Type>
+void BitBoard::generatePawnMoves(MoveList& moves, const GenContext &ctx) const {
+    constexpr Color Them = (Us == WHITE) ? BLACK : WHITE;
+    constexpr int Up = (Us == WHITE) ? -8 : 8;
+    constexpr int UpLeft = Up - 1;   // towards the a-file
+    constexpr int UpRight = Up + 1;  // towards the h-file
+    constexpr uint64_t seventhRankBB = (Us == WHITE) ? 0x000000000000FF00ULL : 0x00FF000000000000ULL;
+    constexpr uint64_t thirdRankBB   = (Us == WHITE) ? 0x0000FF0000000000ULL : 0x0000000000FF0000ULL;
+
+    uint64_t empty = ~pieces();
+    uint64_t enemies = pieces(~Us);
+    uint64_t pawns = pieces(Us, PT_PAWN);
+    uint64_t promoting = pawns & seventhRankBB;
+    uint64_t others = pawns & ~seventhRankBB;
+
+    // squares a pawn of ours would give check from
+    uint64_t checkSquares = 0;
+    if constexpr (Type == GEN_QUIET_CHECKS) checkSquares = getPawnAttacks(ctx.theirKingSquare, Them);
+
+    // the per move part: pins, and for quiet checks whether the move checks at all
+    auto allowed = [&](int from, int to) {
+        if ((ctx.pinned & (1ULL << from)) && !(lineBB[ctx.kingSquare][from] & (1ULL << to))) return false;
+        if constexpr (Type == GEN_QUIET_CHECKS) {
+            return (checkSquares & (1ULL << to))
+                || ((ctx.discoverers & (1ULL << from)) && !(lineBB[ctx.theirKingSquare][from] & (1ULL << to)));
+        }
+        return true;
+    };
+
+    // Single and double pushes
+    if constexpr (Type != GEN_CAPTURES) {
+        uint64_t single = shiftBB<Up>(others) & empty;
+        uint64_t twice = shiftBB<Up>(single & thirdRankBB) & empty & ctx.target;
+        single &= ctx.target;
+
+        while (single) {
+            int to = popLSB(single);
+            if (allowed(to - Up, to)) moves.push_back(Move(to - Up, to));
+        }
+        while (twice) {
+            int to = popLSB(twice);
+            if (allowed(to - 2 * Up, to)) moves.push_back(Move(to - 2 * Up, to));
+        }
+    }
+
+    // Promotions, quiet ones count as quiets and capturing ones as captures
+    if (promoting) {
+        if constexpr (Type == GEN_QUIETS || Type == GEN_ALL) {
+            uint64_t pushes = shiftBB<Up>(promoting) & empty & ctx.target;
+            while (pushes) {
+                int to = popLSB(pushes);
+                if (allowed(to - Up, to)) addPromotions(moves, to - Up, to);
             }
-                
-            case WN: case BN: {
-                uint64_t attacks = getKnightAttacks(square) & enemies;
-                while (attacks) {
-                    int targetSquare = popLSB(attacks);
-                    Piece captured = getPiece(targetSquare);
-                    captures.push_back(Move(piece, square, targetSquare, 0, captured));
-                }
-                break;
+        }
+        if constexpr (Type == GEN_CAPTURES || Type == GEN_ALL) {
+            uint64_t left = shiftBB<UpLeft>(promoting & ~FILE_A_BB) & enemies & ctx.target;
+            uint64_t right = shiftBB<UpRight>(promoting & ~FILE_H_BB) & enemies & ctx.target;
+            while (left) {
+                int to = popLSB(left);
+                if (allowed(to - UpLeft, to)) addPromotions(moves, to - UpLeft, to);
             }
-                
-            case WK: case BK: {
-                uint64_t attacks = getKingAttacks(square) & enemies;
-                while (attacks) {
-                    int targetSquare = popLSB(attacks);
-                    Piece captured = getPiece(targetSquare);
-                    captures.push_back(Move(piece, square, targetSquare, 0, captured));
-                }
-                break;
+            while (right) {
+                int to = popLSB(right);
+                if (allowed(to - UpRight, to)) addPromotions(moves, to - UpRight, to);
             }
-                
-            default:
-                break;
         }
     }
-    return captures;
-}
 
-void BitBoard::generatePawnMoves(int square, std::vector<Move>& moves, Piece p, Color color) const {
-    uint64_t occupied = getAllPieces();
-    uint64_t enemies = (color == WHITE) ? getBlackPieces() : getWhitePieces();
-    
-    int forward = (color == WHITE) ? -8 : 8;
-    int startRank = (color == WHITE) ? 6 : 1;
-    int promotionRank = (color == WHITE) ? 0 : 7;
-    
-    // Forward moves
-    int frontSquare = square + forward;
-    if (frontSquare >= 0 && frontSquare < 64 && !(occupied & (1ULL << frontSquare))) {
-        if (frontSquare / 8 == promotionRank) {
-            // Promotion - (piece, from, to, promotion, capture, kCastle, qCastle, enPassant)
-            // Correct version:
-            Piece baseQueen = (color == WHITE) ? WQ : BQ;
-            Piece baseRook = (color == WHITE) ? WR : BR;
-            Piece baseBishop = (color == WHITE) ? WB : BB;
-            Piece baseKnight = (color == WHITE) ? WN : BN;
-
-            moves.push_back(Move(p, square, frontSquare, baseQueen, 0));
-            moves.push_back(Move(p, square, frontSquare, baseRook, 0));
-            moves.push_back(Move(p, square, frontSquare, baseBishop, 0));
-            moves.push_back(Move(p, square, frontSquare, baseKnight, 0));
-        } else {
-            moves.push_back(Move(p, square, frontSquare));
-            
-            // Double push from starting position
-            if (square / 8 == startRank) {
-                int doublePush = frontSquare + forward;
-                if (!(occupied & (1ULL << doublePush))) {
-                    moves.push_back(Move(p, square, doublePush));
-                }
-            }
+    // Captures and en passant
+    if constexpr (Type == GEN_CAPTURES || Type == GEN_ALL) {
+        uint64_t left = shiftBB<UpLeft>(others & ~FILE_A_BB) & enemies & ctx.target;
+        uint64_t right = shiftBB<UpRight>(others & ~FILE_H_BB) & enemies & ctx.target;
+
+        while (left) {
+            int to = popLSB(left);
+            if (allowed(to - UpLeft, to)) moves.push_back(Move(to - UpLeft, to));
         }
-    }
-    
-    // Captures
-    uint64_t attacks = getPawnAttacks(square, color);
-    uint64_t attacksCopy = attacks;
-    while (attacksCopy) {
-        int targetSquare = popLSB(attacksCopy);
-        if (enemies & (1ULL << targetSquare)) {
-            Piece captured = getPiece(targetSquare);
-            if (targetSquare / 8 == promotionRank) {
-                // Promotion with capture
-                Piece baseQueen = (color == WHITE) ? WQ : BQ;
-                Piece baseRook = (color == WHITE) ? WR : BR;
-                Piece baseBishop = (color == WHITE) ? WB : BB;
-                Piece baseKnight = (color == WHITE) ? WN : BN;
-                
-                moves.push_back(Move(p, square, targetSquare, baseQueen, captured));
-                moves.push_back(Move(p, square, targetSquare, baseRook, captured));
-                moves.push_back(Move(p, square, targetSquare, baseBishop, captured));
-                moves.push_back(Move(p, square, targetSquare, baseKnight, captured));
-            } else {
-                moves.push_back(Move(p, square, targetSquare, 0, captured));
+        while (right) {
+            int to = popLSB(right);
+            if (allowed(to - UpRight, to)) moves.push_back(Move(to - UpRight, to));
+        }
+
+        if (enPassantSquare != -1) {
+            uint64_t epPawns = others & getPawnAttacks(enPassantSquare, Them);
+            while (epPawns) {
+                int from = popLSB(epPawns);
+                if (isEnPassantLegal(from)) moves.push_back(Move(from, enPassantSquare, MT_EN_PASSANT));
             }
         }
     }
-    
-    // En passant
-    if (enPassantSquare != -1) {
-        uint64_t epAttacks = getPawnAttacks(square, color);
-        if (epAttacks & (1ULL << enPassantSquare)) {
-            // (piece, from, to, promotion, capture, kCastle, qCastle, enPassant)
-            moves.push_back(Move(p, square, enPassantSquare, 0, 0, false, false, true));
+}
+
+template<Color Us, GenType Type, PieceType Pt>
+void BitBoard::generatePieceMoves(MoveList& moves, const GenContext &ctx) const {
+    uint64_t occupied = pieces();
+    uint64_t ours = pieces(Us, Pt);
+
+    // squares this piece type would give check from
+    uint64_t checkSquares = 0;
+    if constexpr (Type == GEN_QUIET_CHECKS) checkSquares = attacksFrom<Pt>(ctx.theirKingSquare, occupied);
+
+    while (ours) {
+        int square = popLSB(ours);
+        uint64_t attacks = attacksFrom<Pt>(square, occupied) & ctx.target;
+
+        if (ctx.pinned & (1ULL << square)) attacks &= lineBB[ctx.kingSquare][square];
+        if constexpr (Type == GEN_QUIET_CHECKS) {
+            attacks &= (ctx.discoverers & (1ULL << square)) ? checkSquares | ~lineBB[ctx.theirKingSquare][square] : checkSquares;
+        }
+
+        while (attacks) {
+            moves.push_back(Move(square, popLSB(attacks)));
         }
     }
 }
 
-void BitBoard::generateRookMoves(int square, std::vector<Move>& moves, Piece p, Color color) const {
-    uint64_t occupied = getAllPieces();
-    uint64_t enemies = (color == WHITE) ? getBlackPieces() : getWhitePieces();
-    uint64_t allies = (color == WHITE) ? getWhitePieces() : getBlackPieces();
-    
-    uint64_t attacks = getRookAttacks(square, occupied);
-    attacks &= ~allies; // Remove squares occupied by own pieces
-    
-    while (attacks) {
-        int targetSquare = popLSB(attacks);
-        Piece captured = (enemies & (1ULL << targetSquare)) ? getPiece(targetSquare) : NONE;
-        moves.push_back(Move(p, square, targetSquare, 0, captured));
+template<Color Us, GenType Type>
+void BitBoard::generateKingMoves(MoveList& moves, const GenContext &ctx) const {
+    uint64_t enemies = pieces(~Us);
+    uint64_t attacks = getKingAttacks(ctx.kingSquare) & ctx.target;
+
+    // the king can only give a discovered check
+    if constexpr (Type == GEN_QUIET_CHECKS) {
+        if (!(ctx.discoverers & (1ULL << ctx.kingSquare))) return;
+        attacks &= ~lineBB[ctx.theirKingSquare][ctx.kingSquare];
     }
-}
 
-void BitBoard::generateBishopMoves(int square, std::vector<Move>& moves, Piece p, Color color) const {
-    uint64_t occupied = getAllPieces();
-    uint64_t enemies = (color == WHITE) ? getBlackPieces() : getWhitePieces();
-    uint64_t allies = (color == WHITE) ? getWhitePieces() : getBlackPieces();
-    
-    uint64_t attacks = getBishopAttacks(square, occupied);
-    attacks &= ~allies; // Remove squares occupied by own pieces
+    // the king is taken off the board, otherwise it would hide the squares behind it from a checking slider
+    uint64_t occupied = pieces() ^ (1ULL << ctx.kingSquare);
     
     while (attacks) {
         int targetSquare = popLSB(attacks);
-        Piece captured = (enemies & (1ULL << targetSquare)) ? getPiece(targetSquare) : NONE;
-        moves.push_back(Move(p, square, targetSquare, 0, captured));
+        if (!(attackersTo(targetSquare, occupied) & enemies)) {
+            moves.push_back(Move(ctx.kingSquare, targetSquare));
+        }
     }
 }
 
-void BitBoard::generateQueenMoves(int square, std::vector<Move>& moves, Piece p, Color color) const {
-    uint64_t occupied = getAllPieces();
-    uint64_t enemies = (color == WHITE) ? getBlackPieces() : getWhitePieces();
-    uint64_t allies = (color == WHITE) ? getWhitePieces() : getBlackPieces();
-    
-    uint64_t attacks = getQueenAttacks(square, occupied);
-    attacks &= ~allies; // Remove squares occupied by own pieces
-    
-    while (attacks) {
-        int targetSquare = popLSB(attacks);
-        Piece captured = (enemies & (1ULL << targetSquare)) ? getPiece(targetSquare) : NONE;
-        moves.push_back(Move(p, square, targetSquare, 0, captured));
+// only called when not in check, so the king's own square is known to be safe
+template<Color Us>
+void BitBoard::generateCastling(MoveList& moves) const {
+    constexpr Color Them = (Us == WHITE) ? BLACK : WHITE;
+    constexpr int kingFrom = (Us == WHITE) ? 60 : 4;
+    constexpr uint64_t kingSideEmpty  = (Us == WHITE) ? 0x6000000000000000ULL : 0x0000000000000060ULL; // f and g
+    constexpr uint64_t queenSideEmpty = (Us == WHITE) ? 0x0E00000000000000ULL : 0x000000000000000EULL; // b, c and d
+
+    bool kingSide  = castlingRights & ((Us == WHITE) ? WHITE_KINGSIDE : BLACK_KINGSIDE);
+    bool queenSide = castlingRights & ((Us == WHITE) ? WHITE_QUEENSIDE : BLACK_QUEENSIDE);
+    int kingSquare = (Us == WHITE) ? whiteKingSquare : blackKingSquare;
+
+    if (kingSquare != kingFrom) return;
+
+    if (kingSide && !(pieces() & kingSideEmpty)) {
+        if (!isSquareAttacked(kingFrom + 1, Them) && !isSquareAttacked(kingFrom + 2, Them)) {
+            moves.push_back(Move(kingFrom, kingFrom + 2, MT_CASTLING));
+        }
+    }
+    if (queenSide && !(pieces() & queenSideEmpty)) {
+        if (!isSquareAttacked(kingFrom - 1, Them) && !isSquareAttacked(kingFrom - 2, Them)) {
+            moves.push_back(Move(kingFrom, kingFrom - 2, MT_CASTLING));
+        }
     }
 }
 
-void BitBoard::generateKnightMoves(int square, std::vector<Move>& moves, Piece p, Color color) const {
-    uint64_t allies = (color == WHITE) ? getWhitePieces() : getBlackPieces();
-    uint64_t enemies = (color == WHITE) ? getBlackPieces() : getWhitePieces();
-    
-    uint64_t attacks = getKnightAttacks(square);
-    attacks &= ~allies; // Remove squares occupied by own pieces
-    
-    while (attacks) {
-        int targetSquare = popLSB(attacks);
-        Piece captured = (enemies & (1ULL << targetSquare)) ? getPiece(targetSquare) : NONE;
-        moves.push_back(Move(p, square, targetSquare, 0, captured));
+// Out of check. Only legal moves are generated: a piece pinned to its king stays on the pin line
+// and the king never steps onto an attacked square.
+template<Color Us, GenType Type>
+void BitBoard::generateAll(MoveList& moves) const {
+    uint64_t allies = pieces(Us);
+    uint64_t enemies = pieces(~Us);
+
+    GenContext ctx;
+    ctx.kingSquare = (Us == WHITE) ? whiteKingSquare : blackKingSquare;
+    ctx.theirKingSquare = (Us == WHITE) ? blackKingSquare : whiteKingSquare;
+    ctx.pinned = pinnedPieces();
+    ctx.discoverers = 0;
+
+    if constexpr (Type == GEN_CAPTURES) ctx.target = enemies;
+    else if constexpr (Type == GEN_ALL) ctx.target = ~allies;
+    else ctx.target = ~pieces();
+
+    if constexpr (Type == GEN_QUIET_CHECKS) {
+        uint64_t queens = pieces(Us, PT_QUEEN);
+        ctx.discoverers = sliderBlockers(ctx.theirKingSquare, pieces(Us, PT_ROOK) | queens, pieces(Us, PT_BISHOP) | queens) & allies;
     }
+
+    generatePawnMoves<Us, Type>(moves, ctx);
+    generatePieceMoves<Us, Type, PT_KNIGHT>(moves, ctx);
+    generatePieceMoves<Us, Type, PT_BISHOP>(moves, ctx);
+    generatePieceMoves<Us, Type, PT_ROOK>(moves, ctx);
+    generatePieceMoves<Us, Type, PT_QUEEN>(moves, ctx);
+    generateKingMoves<Us, Type>(moves, ctx);
+
+    if constexpr (Type == GEN_QUIETS || Type == GEN_ALL) generateCastling<Us>(moves);
 }
 
-void BitBoard::generateKingMoves(int square, std::vector<Move>& moves, Piece p, Color color) const {
-    uint64_t allies = (color == WHITE) ? getWhitePieces() : getBlackPieces();
-    uint64_t enemies = (color == WHITE) ? getBlackPieces() : getWhitePieces();
-    
-    uint64_t attacks = getKingAttacks(square);
-    attacks &= ~allies; // Remove squares occupied by own pieces
-    
-    while (attacks) {
-        int targetSquare = popLSB(attacks);
-        Piece captured = (enemies & (1ULL << targetSquare)) ? getPiece(targetSquare) : NONE;
-        moves.push_back(Move(p, square, targetSquare, 0, captured));
-    }
-    
-    // Castling moves
-    if (color == WHITE) {
-        // White kingside castling
-        if (whiteKingsideCastle && square == 60) {
-            if (!(getAllPieces() & 0x6000000000000000ULL)) { // f1 and g1 empty
-                if (!isSquareAttacked(60, BLACK) && !isSquareAttacked(61, BLACK) && !isSquareAttacked(62, BLACK)) {
-                    moves.push_back(Move(p, square, 62, 0, 0, true, false, false));
-                }
+// Out of check there are only three ways: move the king, capture the checker or put something
+// in between. Only the squares that do one of those are looked at, instead of every piece's moves.
+// Type narrows it to the capturing (GEN_CAPTURES) or quiet (GEN_QUIETS) evasions.
+template<Color Us, GenType Type>
+void BitBoard::generateEvasions(MoveList& moves, uint64_t checkMask) const {
+    constexpr Color Them = (Us == WHITE) ? BLACK : WHITE;
+    constexpr int forward = (Us == WHITE) ? -8 : 8;
+    constexpr int promotionRank = (Us == WHITE) ? 0 : 7;
+    constexpr int doublePushRank = (Us == WHITE) ? 4 : 3;
+
+    uint64_t occupied = pieces();
+    uint64_t allies = pieces(Us);
+    uint64_t enemies = pieces(~Us);
+    uint64_t pawns = pieces(Us, PT_PAWN);
+
+    GenContext ctx;
+    ctx.kingSquare = (Us == WHITE) ? whiteKingSquare : blackKingSquare;
+    ctx.theirKingSquare = (Us == WHITE) ? blackKingSquare : whiteKingSquare;
+    ctx.pinned = 0;
+    ctx.discoverers = 0;
+
+    if constexpr (Type == GEN_CAPTURES) ctx.target = enemies;
+    else if constexpr (Type == GEN_QUIETS) ctx.target = ~occupied;
+    else ctx.target = ~allies;
+
+    generateKingMoves<Us, Type>(moves, ctx);
+
+    // double check, only the king can move
+    if (checkMask & (checkMask - 1)) return;
+
+    // a pinned piece can never resolve a check: it would have to leave the pin line
+    uint64_t movable = allies & ~(1ULL << ctx.kingSquare) & ~pinnedPieces();
+    int checkerSquare = getLSB(checkMask);
+
+    if constexpr (Type != GEN_QUIETS) {
+        // Capture the checker
+        uint64_t capturers = attackersTo(checkerSquare, occupied) & movable;
+        while (capturers) {
+            int from = popLSB(capturers);
+            if ((pawns & (1ULL << from)) && checkerSquare / 8 == promotionRank) {
+                addPromotions(moves, from, checkerSquare);
+            } else {
+                moves.push_back(Move(from, checkerSquare));
             }
         }
-        // White queenside castling
-        if (whiteQueensideCastle && square == 60) {
-            if (!(getAllPieces() & 0x0E00000000000000ULL)) { // b1, c1, d1 empty
-                if (!isSquareAttacked(60, BLACK) && !isSquareAttacked(59, BLACK) && !isSquareAttacked(58, BLACK)) {
-                    moves.push_back(Move(p, square, 58, 0, 0, false, true, false));
-                }
+
+        // the checker is the pawn that just made a double push
+        if (enPassantSquare != -1 && checkerSquare == enPassantSquare - forward) {
+            uint64_t epPawns = getPawnAttacks(enPassantSquare, Them) & pawns;
+            while (epPawns) {
+                int from = popLSB(epPawns);
+                if (isEnPassantLegal(from)) moves.push_back(Move(from, enPassantSquare, MT_EN_PASSANT));
             }
         }
-    } else {
-        // Black kingside castling
-        if (blackKingsideCastle && square == 4) {
-            if (!(getAllPieces() & 0x0000000000000060ULL)) { // f8 and g8 empty
-                if (!isSquareAttacked(4, WHITE) && !isSquareAttacked(5, WHITE) && !isSquareAttacked(6, WHITE)) {
-                    moves.push_back(Move(p, square, 6, 0, 0, true, false, false));
-                }
+    }
+
+    if constexpr (Type != GEN_CAPTURES) {
+        // Block the checking ray (empty for contact checks and knights)
+        uint64_t blocks = betweenBB[ctx.kingSquare][checkerSquare];
+        while (blocks) {
+            int square = popLSB(blocks);
+
+            // pawn attacks only capture, they can't land on an empty square
+            uint64_t blockers = attackersTo(square, occupied) & movable & ~pawns;
+            while (blockers) {
+                moves.push_back(Move(popLSB(blockers), square));
             }
-        }
-        // Black queenside castling
-        if (blackQueensideCastle && square == 4) {
-            if (!(getAllPieces() & 0x000000000000000EULL)) { // b8, c8, d8 empty
-                if (!isSquareAttacked(4, WHITE) && !isSquareAttacked(3, WHITE) && !isSquareAttacked(2, WHITE)) {
-                    moves.push_back(Move(p, square, 2, 0, 0, false, true, false));
-                }
+
+            int from = square - forward;
+            if (from < 0 || from > 63) continue;
+
+            if (pawns & movable & (1ULL << from)) {
+                if (square / 8 == promotionRank) addPromotions(moves, from, square);
+                else moves.push_back(Move(from, square));
+            }
+            else if (square / 8 == doublePushRank && !(occupied & (1ULL << from))
+                     && (pawns & movable & (1ULL << (from - forward)))) {
+                moves.push_back(Move(from - forward, square));
             }
         }
     }
 }
 
-bool BitBoard::makeMove(const Move &move) {
-    Gamestate prevState = {
-        sideToMove, 
+template<GenType Type>
+void BitBoard::generate(MoveList &moves) const {
+    moves.clear();
+    uint64_t checkMask = checkers();
+
+    if constexpr (Type == GEN_EVASIONS) {
+        assert(checkMask);
+        if (sideToMove == WHITE) generateEvasions<WHITE, GEN_EVASIONS>(moves, checkMask);
+        else generateEvasions<BLACK, GEN_EVASIONS>(moves, checkMask);
+    }
+    else if constexpr (Type == GEN_QUIET_CHECKS) {
+        // a check can't be answered with a quiet check unless it is also an evasion, leave those to GEN_EVASIONS
+        if (checkMask) return;
+        if (sideToMove == WHITE) generateAll<WHITE, GEN_QUIET_CHECKS>(moves);
+        else generateAll<BLACK, GEN_QUIET_CHECKS>(moves);
+    }
+    else {
+        // in check every category is a subset of the evasions
+        constexpr GenType EvasionType = (Type == GEN_ALL) ? GEN_EVASIONS : Type;
+        if (checkMask) {
+            if (sideToMove == WHITE) generateEvasions<WHITE, EvasionType>(moves, checkMask);
+            else generateEvasions<BLACK, EvasionType>(moves, checkMask);
+        }
+        else {
+            if (sideToMove == WHITE) generateAll<WHITE, Type>(moves);
+            else generateAll<BLACK, Type>(moves);
+        }
+    }
+}
+
+template void BitBoard::generate<GEN_CAPTURES>(MoveList &moves) const;
+template void BitBoard::generate<GEN_QUIETS>(MoveList &moves) const;
+template void BitBoard::generate<GEN_QUIET_CHECKS>(MoveList &moves) const;
+template void BitBoard::generate<GEN_EVASIONS>(MoveList &moves) const;
+template void BitBoard::generate<GEN_ALL>(MoveList &moves) const;
+
+// Checked from the board alone so the search can try a TT move or killer before generating anything.
+// The move may come from an unrelated position (a TT key collision), so nothing about it is trusted:
+// any 16 bit value is answered correctly, only the king's safety is left to isLegal().
+bool BitBoard::isPseudoLegal(const Move &move) const {
+    if (move.isNone()) return false;
+
+    int from = move.from();
+    int to = move.to();
+    uint64_t occupied = pieces();
+    uint64_t allies = pieces(sideToMove);
+    uint64_t enemies = occupied & ~allies;
+
+    Piece piece = getPiece(from);
+    if (!(allies & (1ULL << from)) || (allies & (1ULL << to))) return false;
+
+    // the promotion bits are only used by promotions, everything else is generated with them zero
+    if (!move.isPromotion() && move.promotionType() != PT_KNIGHT) return false;
+
+    if (move.isCastle()) {
+        int kingFrom = (sideToMove == WHITE) ? 60 : 4;
+        if (from != kingFrom || typeOf(piece) != PT_KING) return false;
+
+        if (to == kingFrom + 2) {
+            bool right = castlingRights & ((sideToMove == WHITE) ? WHITE_KINGSIDE : BLACK_KINGSIDE);
+            return right && !(occupied & betweenBB[kingFrom][kingFrom + 3]);
+        }
+        if (to == kingFrom - 2) {
+            bool right = castlingRights & ((sideToMove == WHITE) ? WHITE_QUEENSIDE : BLACK_QUEENSIDE);
+            return right && !(occupied & betweenBB[kingFrom][kingFrom - 4]);
+        }
+        return false;
+    }
+
+    if (typeOf(piece) != PT_PAWN) {
+        if (move.isPromotion() || move.isEnPassant()) return false;
+
+        uint64_t attacks;
+        switch (typeOf(piece)) {
+            case PT_KNIGHT: attacks = getKnightAttacks(from); break;
+            case PT_BISHOP: attacks = getBishopAttacks(from, occupied); break;
+            case PT_ROOK:   attacks = getRookAttacks(from, occupied); break;
+            case PT_QUEEN:  attacks = getQueenAttacks(from, occupied); break;
+            default:        attacks = getKingAttacks(from); break;
+        }
+        return attacks & (1ULL << to);
+    }
+
+    int forward = (sideToMove == WHITE) ? -8 : 8;
+    int promotionRank = (sideToMove == WHITE) ? 0 : 7;
+    int startRank = (sideToMove == WHITE) ? 6 : 1;
+    uint64_t captures = getPawnAttacks(from, sideToMove);
+
+    if (move.isEnPassant()) {
+        return to == enPassantSquare && (captures & (1ULL << to));
+    }
+
+    // a pawn reaching the last rank must promote, and only there
+    if (move.isPromotion() != (to / 8 == promotionRank)) return false;
+
+    if (captures & enemies & (1ULL << to)) return true;
+    if (occupied & (1ULL << to)) return false;
+    if (to == from + forward) return true;
+    return to == from + 2 * forward && from / 8 == startRank && !(occupied & (1ULL << (from + forward)));
+}
+
+// Whether a pseudo legal move leaves our king safe. Cheap for the common case of an unpinned piece
+// out of check; the generators get the same answer from the pin and check masks.
+bool BitBoard::isLegal(const Move &move) const {
+    int from = move.from();
+    int to = move.to();
+    Color them = (sideToMove == WHITE) ? BLACK : WHITE;
+    int kingSquare = (sideToMove == WHITE) ? whiteKingSquare : blackKingSquare;
+    uint64_t enemies = pieces(~sideToMove);
+    uint64_t checking = checkers();
+
+    if (move.isEnPassant()) return isEnPassantLegal(from);
+
+    if (move.isCastle()) {
+        int step = (to > from) ? 1 : -1;
+        return !checking && !isSquareAttacked(from + step, them) && !isSquareAttacked(to, them);
+    }
+
+    if (from == kingSquare) {
+        // the king is taken off the board so a slider's ray carries on behind it
+        uint64_t occupied = pieces() ^ (1ULL << from);
+        return !(attackersTo(to, occupied) & enemies & ~(1ULL << to));
+    }
+
+    if (checking) {
+        // one checker only, and the move has to capture it or block it
+        if (checking & (checking - 1)) return false;
+        int checkerSquare = getLSB(checking);
+        if (!((betweenBB[kingSquare][checkerSquare] | checking) & (1ULL << to))) return false;
+    }
+
+    return !(pinnedPieces() & (1ULL << from)) || (lineBB[kingSquare][from] & (1ULL << to));
+}
+
+void BitBoard::makeMove(const Move &move) {
+    Piece piece = getPiece(move.from());
+    Piece captured = capturedPiece(move);
+
+    assert(stateCount < MAX_STATES);
+    StateInfo &prevState = states[stateCount++];
+    prevState = {
+        zobristKey,
+        checkersBB,
         enPassantSquare,
-        whiteKingsideCastle,
-        whiteQueensideCastle,
-        blackKingsideCastle,
-        blackQueensideCastle,
-        whiteKingSquare,
-        blackKingSquare,
-        zobristKey
+        halfmoveClock,
+        castlingRights,
+        captured
     };
 
+    // the fifty move count starts over on captures and pawn moves
+    halfmoveClock = (captured != NONE || typeOf(piece) == PT_PAWN) ? 0 : halfmoveClock + 1;
+
     if(enPassantSquare != -1) {
         int file = enPassantSquare & 7;
         zobristKey ^= zobristEnPassant[file];
@@ -512,15 +775,13 @@ bool BitBoard::makeMove(const Move &move) {
     enPassantSquare = -1;
     
     // Castle updates
-    if(move.isKingSideCastle) {
+    if(move.isKingSideCastle()) {
         if(sideToMove == WHITE) {
             setPiece(WR, 61);
             setPiece(WK, 62);
             setPiece(NONE, 60);
             setPiece(NONE, 63);
             whiteKingSquare = 62;
-            whiteKingsideCastle = false;
-            whiteQueensideCastle = false;
 
             // Zobrist changes
             xorPiece(zobristKey, WK, 60);
@@ -534,8 +795,6 @@ bool BitBoard::makeMove(const Move &move) {
             setPiece(NONE, 4);
             setPiece(NONE, 7);
             blackKingSquare = 6;
-            blackKingsideCastle = false;
-            blackQueensideCastle = false;
 
             // Zobrist changes
             xorPiece(zobristKey, BK, 4);
@@ -544,15 +803,13 @@ bool BitBoard::makeMove(const Move &move) {
             xorPiece(zobristKey, BR, 5);
         }
     }
-    else if(move.isQueenSideCastle) {
+    else if(move.isQueenSideCastle()) {
         if(sideToMove == WHITE) {
             setPiece(WR, 59);
             setPiece(WK, 58);
             setPiece(NONE, 60);
             setPiece(NONE, 56);
             whiteKingSquare = 58;
-            whiteKingsideCastle = false;
-            whiteQueensideCastle = false;
 
             // Zobrist Changes
             xorPiece(zobristKey, WK, 60);
@@ -566,8 +823,6 @@ bool BitBoard::makeMove(const Move &move) {
             setPiece(NONE, 4);
             setPiece(NONE, 0);
             blackKingSquare = 2;
-            blackKingsideCastle = false;
-            blackQueensideCastle = false;
 
             // Zobrist Changes
             xorPiece(zobristKey, BK, 4);
@@ -576,195 +831,217 @@ bool BitBoard::makeMove(const Move &move) {
             xorPiece(zobristKey, BR, 3);
         }
     }
-    else if(move.isEnPassant) { // en passant
-        setPiece(NONE, move.from);
-        setPiece(move.piece, move.to);
+    else if(move.isEnPassant()) { // en passant
+        setPiece(NONE, move.from());
+        setPiece(piece, move.to());
 
-        int capturedPawnSquare = move.to + (sideToMove == WHITE? 8 : -8);
-        Piece capturedPiece = getPiece(capturedPawnSquare);
+        int capturedPawnSquare = move.to() + (sideToMove == WHITE? 8 : -8);
         setPiece(NONE, capturedPawnSquare);
 
         // Zobrist Changes
-        xorPiece(zobristKey, move.piece, move.from);
-        xorPiece(zobristKey, move.piece, move.to);
-        xorPiece(zobristKey, capturedPiece, capturedPawnSquare);
+        xorPiece(zobristKey, piece, move.from());
+        xorPiece(zobristKey, piece, move.to());
+        xorPiece(zobristKey, captured, capturedPawnSquare);
     }
     else {
         // normal moves and captures
-        if(move.piece == WP || move.piece == BP) {
-            if(abs(move.from - move.to) == 16) {
-                enPassantSquare = move.from + (sideToMove == WHITE? -8 : 8);
+        if(piece == WP || piece == BP) {
+            if(abs(move.from() - move.to()) == 16) {
+                enPassantSquare = move.from() + (sideToMove == WHITE? -8 : 8);
                 // zobrist changes
                 int file = enPassantSquare & 7;
                 zobristKey ^= zobristEnPassant[file];
             }
 
-            if(move.promotion) {
-                if(move.capture) {
-                    setPiece(NONE, move.to);
+            if(move.isPromotion()) {
+                if(captured) {
+                    setPiece(NONE, move.to());
                     // zobrist changes
-                    xorPiece(zobristKey, (Piece)move.capture, move.to);
+                    xorPiece(zobristKey, captured, move.to());
                 } 
 
-                setPiece(NONE, move.from);
-                // The promotion piece is already correct from move generation
-                Piece promoteTo = (Piece)move.promotion;
-                setPiece(promoteTo, move.to);
+                setPiece(NONE, move.from());
+                Piece promoteTo = makePiece(sideToMove, move.promotionType());
+                setPiece(promoteTo, move.to());
 
                 // Zobrist changes
-                xorPiece(zobristKey, move.piece, move.from);
-                xorPiece(zobristKey, promoteTo, move.to);
+                xorPiece(zobristKey, piece, move.from());
+                xorPiece(zobristKey, promoteTo, move.to());
             }
             else {
-                if(move.capture) xorPiece(zobristKey, (Piece)move.capture, move.to);
+                if(captured) xorPiece(zobristKey, captured, move.to());
 
-                setPiece(NONE, move.from);
-                setPiece(move.piece, move.to);
+                setPiece(NONE, move.from());
+                setPiece(piece, move.to());
 
                 // Zobrist changes
-                xorPiece(zobristKey, move.piece, move.from);
-                xorPiece(zobristKey, move.piece, move.to);
+                xorPiece(zobristKey, piece, move.from());
+                xorPiece(zobristKey, piece, move.to());
             }
         }
         else {
-            if(move.capture) xorPiece(zobristKey, (Piece)move.capture, move.to);
+            if(captured) xorPiece(zobristKey, captured, move.to());
 
-            setPiece(NONE, move.from);
-            setPiece(move.piece, move.to);
+            setPiece(NONE, move.from());
+            setPiece(piece, move.to());
 
             // Zobrist changes
-            xorPiece(zobristKey, move.piece, move.from);
-            xorPiece(zobristKey, move.piece, move.to);
-        }
-
-        if (move.piece == WK) {
-            whiteKingsideCastle = false;
-            whiteQueensideCastle = false;
-            whiteKingSquare = move.to;
-        } else if (move.piece == BK) {
-            blackKingsideCastle = false;
-            blackQueensideCastle = false;
-            blackKingSquare = move.to;
-        } else if (move.piece == WR) {
-            if (move.from == 56) whiteQueensideCastle = false;
-            if (move.from == 63) whiteKingsideCastle = false;
-        } else if (move.piece == BR) {
-            if (move.from == 0) blackQueensideCastle = false;
-            if (move.from == 7) blackKingsideCastle = false;
-        }
-        if (move.capture) {
-            if (move.to == 56) whiteQueensideCastle = false;
-            if (move.to == 63) whiteKingsideCastle = false;
-            if (move.to == 0) blackQueensideCastle = false;
-            if (move.to == 7) blackKingsideCastle = false;
-        }
-    }
-
-    // zobrist changes
-    if(prevState.whiteKingsideCastle != whiteKingsideCastle) zobristKey ^= zobristCastling[0];
-    if(prevState.whiteQueensideCastle != whiteQueensideCastle) zobristKey ^= zobristCastling[1];
-    if(prevState.blackKingsideCastle != blackKingsideCastle) zobristKey ^= zobristCastling[2];
-    if(prevState.blackQueensideCastle != blackQueensideCastle) zobristKey ^= zobristCastling[3];
-
-    sideToMove = (sideToMove == WHITE)? BLACK : WHITE;
-    zobristKey ^= zobristBlackToMove;
+            xorPiece(zobristKey, piece, move.from());
+            xorPiece(zobristKey, piece, move.to());
+        }
 
+        if (piece == WK) whiteKingSquare = move.to();
+        else if (piece == BK) blackKingSquare = move.to();
+    }
 
-    if(sideToMove == BLACK) {
-        if(isSquareAttacked(whiteKingSquare, BLACK)){
-            unmakeMove(move, prevState);
-            return false;
-        }
+    int rights = castlingRights & castlingMask[move.from()] & castlingMask[move.to()];
+    if (rights != castlingRights) {
+        zobristKey ^= zobristCastling[castlingRights] ^ zobristCastling[rights];
+        castlingRights = rights;
     }
-    else {
-        if(isSquareAttacked(blackKingSquare, WHITE)) {
-            unmakeMove(move, prevState);
-            return false;
-        }
-    } 
 
-    return true;
+    sideToMove = (sideToMove == WHITE)? BLACK : WHITE;
+    zobristKey ^= zobristBlackToMove;
+
+    checkersBB = computeCheckers();
 }
 
-void BitBoard::unmakeMove(const Move &move, const Gamestate &prevState) {
-    whiteKingsideCastle = prevState.whiteKingsideCastle;
-    whiteQueensideCastle = prevState.whiteQueensideCastle;
-    blackKingsideCastle = prevState.blackKingsideCastle;
-    blackQueensideCastle = prevState.blackQueensideCastle;
-    whiteKingSquare = prevState.whiteKingSquare;
-    blackKingSquare = prevState.blackKingSquare;
+void BitBoard::unmakeMove(const Move &move) {
+    assert(stateCount > 0);
+    const StateInfo &prevState = states[--stateCount];
+
+    castlingRights = prevState.castlingRights;
     enPassantSquare = prevState.enPassantSquare;
+    halfmoveClock = prevState.halfmoveClock;
+    checkersBB = prevState.checkers;
+    zobristKey = prevState.zobristKey;
     sideToMove = (sideToMove == WHITE) ? BLACK : WHITE;
 
-    if (move.isKingSideCastle) {
+    if (move.isKingSideCastle()) {
         if (sideToMove == WHITE) {
             setPiece(WK, 60); 
             setPiece(WR, 63); 
             setPiece(NONE, 62); 
             setPiece(NONE, 61);
+            whiteKingSquare = 60;
         } else {
             setPiece(BK, 4);  
             setPiece(BR, 7);  
             setPiece(NONE, 6); 
             setPiece(NONE, 5);
+            blackKingSquare = 4;
         }
     }
-    else if (move.isQueenSideCastle) {
+    else if (move.isQueenSideCastle()) {
         if (sideToMove == WHITE) {
             setPiece(WK, 60); 
             setPiece(WR, 56); 
             setPiece(NONE, 58); 
             setPiece(NONE, 59);
+            whiteKingSquare = 60;
         } else {
             setPiece(BK, 4);  
             setPiece(BR, 0);  
             setPiece(NONE, 2); 
             setPiece(NONE, 3);
+            blackKingSquare = 4;
         }
     }
-    else if (move.isEnPassant) {
-        setPiece(move.piece, move.from);
-        setPiece(NONE, move.to);
+    else if (move.isEnPassant()) {
+        setPiece(getPiece(move.to()), move.from());
+        setPiece(NONE, move.to());
         
-        int capturedPawnSquare = move.to + (sideToMove == WHITE ? 8 : -8);
+        int capturedPawnSquare = move.to() + (sideToMove == WHITE ? 8 : -8);
         setPiece((sideToMove == WHITE) ? BP : WP, capturedPawnSquare);
     }
     else {
-        setPiece(move.piece, move.from);
-        if (move.promotion && move.capture) {
-            Piece capturedPiece = (Piece)move.capture;
-            setPiece(capturedPiece, move.to);
-        }
-        else if (move.promotion) {
-            setPiece(NONE, move.to);
-        } else if (move.capture) {
-            Piece capturedPiece = (Piece)move.capture;
-            setPiece(capturedPiece, move.to);
-        } else {
-            setPiece(NONE, move.to);
-        }
+        // a promoted piece goes back to being a pawn
+        Piece moved = move.isPromotion() ? makePiece(sideToMove, PT_PAWN) : getPiece(move.to());
+        setPiece(moved, move.from());
+        setPiece(prevState.capturedPiece, move.to());
+
+        if (moved == WK) whiteKingSquare = move.from();
+        else if (moved == BK) blackKingSquare = move.from();
     }
-    
-        
-    zobristKey = prevState.zobristKey;
 }
 
-bool BitBoard::tryMove(const Move& move) {
-    Gamestate prevdata = {
-        sideToMove, 
+// Passes the turn. Only the side to move and the en passant square change, and the side that
+// passes is never in check, so the side that gets the extra move isn't either.
+void BitBoard::makeNullMove() {
+    assert(stateCount < MAX_STATES);
+    StateInfo &prevState = states[stateCount++];
+    prevState = {
+        zobristKey,
+        checkersBB,
         enPassantSquare,
-        whiteKingsideCastle,
-        whiteQueensideCastle,
-        blackKingsideCastle,
-        blackQueensideCastle,
-        whiteKingSquare,
-        blackKingSquare,
-        zobristKey
+        halfmoveClock,
+        castlingRights,
+        NONE
     };
 
-    if(!makeMove(move)) return false;
-    unmakeMove(move, prevdata);
-    return true;
+    if (enPassantSquare != -1) {
+        zobristKey ^= zobristEnPassant[enPassantSquare & 7];
+    }
+    enPassantSquare = -1;
+    ++halfmoveClock;
+    checkersBB = 0;
+
+    sideToMove = (sideToMove == WHITE) ? BLACK : WHITE;
+    zobristKey ^= zobristBlackToMove;
+}
+
+void BitBoard::unmakeNullMove() {
+    assert(stateCount > 0);
+    const StateInfo &prevState = states[--stateCount];
+
+    enPassantSquare = prevState.enPassantSquare;
+    halfmoveClock = prevState.halfmoveClock;
+    checkersBB = prevState.checkers;
+    zobristKey = prevState.zobristKey;
+    sideToMove = (sideToMove == WHITE) ? BLACK : WHITE;
+}
+
+uint64_t BitBoard::keyAfter(const Move &move) const {
+    uint64_t key = zobristKey ^ zobristBlackToMove;
+
+    if(enPassantSquare != -1) {
+        key ^= zobristEnPassant[enPassantSquare & 7];
+    }
+
+    Piece piece = getPiece(move.from());
+    xorPiece(key, piece, move.from());
+
+    if(move.isCastle()) {
+        Piece rook = (sideToMove == WHITE) ? WR : BR;
+        int rookFrom = move.isKingSideCastle() ? move.to() + 1 : move.to() - 2;
+        int rookTo   = move.isKingSideCastle() ? move.to() - 1 : move.to() + 1;
+
+        xorPiece(key, piece, move.to());
+        xorPiece(key, rook, rookFrom);
+        xorPiece(key, rook, rookTo);
+    }
+    else {
+        xorPiece(key, move.isPromotion() ? makePiece(sideToMove, move.promotionType()) : piece, move.to());
+
+        if(move.isEnPassant()) {
+            int capturedPawnSquare = move.to() + (sideToMove == WHITE? 8 : -8);
+            xorPiece(key, (sideToMove == WHITE) ? BP : WP, capturedPawnSquare);
+        }
+        else {
+            Piece captured = getPiece(move.to());
+            if(captured) xorPiece(key, captured, move.to());
+
+            if((piece == WP || piece == BP) && abs(move.from() - move.to()) == 16) {
+                key ^= zobristEnPassant[move.from() & 7];
+            }
+        }
+    }
+
+    // same castling-right update as makeMove
+    int rights = castlingRights & castlingMask[move.from()] & castlingMask[move.to()];
+    key ^= zobristCastling[castlingRights] ^ zobristCastling[rights];
+
+    return key;
 }
 
 void BitBoard::print() const {
@@ -781,13 +1058,7 @@ void BitBoard::print() const {
 }
 
 bool BitBoard::setPositionFromFEN(const std::string& fen) {
-    // Clear all bitboards
-    whitePawns = blackPawns = 0;
-    whiteRooks = blackRooks = 0;
-    whiteBishops = blackBishops = 0;
-    whiteQueens = blackQueens = 0;
-    whiteKnights = blackKnights = 0;
-    whiteKing = blackKing = 0;
+    clearBoard();
     
     std::istringstream ss(fen);
     std::string token;
@@ -836,10 +1107,11 @@ bool BitBoard::setPositionFromFEN(const std::string& fen) {
     
     // 3. Castling availability
     if (!(ss >> token)) return false;
-    whiteKingsideCastle = (token.find('K') != std::string::npos);
-    whiteQueensideCastle = (token.find('Q') != std::string::npos);
-    blackKingsideCastle = (token.find('k') != std::string::npos);
-    blackQueensideCastle = (token.find('q') != std::string::npos);
+    castlingRights = NO_CASTLING;
+    if (token.find('K') != std::string::npos) castlingRights |= WHITE_KINGSIDE;
+    if (token.find('Q') != std::string::npos) castlingRights |= WHITE_QUEENSIDE;
+    if (token.find('k') != std::string::npos) castlingRights |= BLACK_KINGSIDE;
+    if (token.find('q') != std::string::npos) castlingRights |= BLACK_QUEENSIDE;
     
     // 4. En passant target square
     if (!(ss >> token)) return false;
@@ -850,6 +1122,15 @@ bool BitBoard::setPositionFromFEN(const std::string& fen) {
         int rank = 8 - (token[1] - '0');
         enPassantSquare = rank * 8 + file;
     }
+
+    // 5. Halfmove clock, often left out
+    halfmoveClock = 0;
+    if (ss >> token) {
+        try { halfmoveClock = std::stoi(token); } catch (...) {}
+    }
+
+    checkersBB = computeCheckers();
+    zobristKey = generateZobristHashKey(*this);
     
     return true;
 }
\ No newline at end of file
@@ -8,7 +8,6 @@ const int *PST[7] = {pawnPST, knightPST, bishopPST, rookPST, queenPST, kingMdPST
 
 
 
-class Board;
 class BitBoard;
 int evaluatePawnStructure(uint64_t white_pawns, uint64_t black_pawns);
 int evaluateKingSafety(const BitBoard &board);
@@ -18,7 +17,7 @@ int Evaluation::evaluate(const BitBoard &board) {
     int score = 0;
     
     // First pass: calculate phase material
-    uint64_t allPieces = board.getAllPieces();
+    uint64_t allPieces = board.pieces();
     uint64_t tempPieces = allPieces;
     while(tempPieces) {
         int square = board.popLSB(tempPieces);
@@ -32,7 +31,7 @@ int Evaluation::evaluate(const BitBoard &board) {
     bool endgame = phaseMaterial <= 1300;
     
     // Evaluate white pieces
-    uint64_t whitePieces = board.getWhitePieces();
+    uint64_t whitePieces = board.pieces(WHITE);
     while(whitePieces) {
         int square = board.popLSB(whitePieces);
         Piece p = board.getPiece(square);
@@ -47,7 +46,7 @@ int Evaluation::evaluate(const BitBoard &board) {
     }
     
     // Evaluate black pieces
-    uint64_t blackPieces = board.getBlackPieces();
+    uint64_t blackPieces = board.pieces(BLACK);
     while(blackPieces) {
         int square = board.popLSB(blackPieces);
         Piece p = board.getPiece(square);
@@ -62,7 +61,7 @@ int Evaluation::evaluate(const BitBoard &board) {
     }
 
     // Pawn Structure
-    score += evaluatePawnStructure(board.whitePawns, board.blackPawns);
+    score += evaluatePawnStructure(board.pieces(WHITE, PT_PAWN), board.pieces(BLACK, PT_PAWN));
 
     // King Safety (only in middlegame)
     if (!endgame) {
@@ -98,7 +97,7 @@ int evaluateKingSafety(const BitBoard &board) {
     int shieldBonus = 0;
     for (int f = whiteKingFile - 1; f <= whiteKingFile + 1; ++f) {
         if (f >= 0 && f < 8) {
-            uint64_t fileSquares = FILES[f] & board.getWhitePawns();
+            uint64_t fileSquares = FILES[f] & board.pieces(WHITE, PT_PAWN);
             if (fileSquares) {
                 // Find closest pawn to king
                 int pawnSquare = __builtin_clzll(fileSquares | 1) ^ 63;
@@ -121,7 +120,7 @@ int evaluateKingSafety(const BitBoard &board) {
     int openFilePenalty = 0;
     for (int f = whiteKingFile - 1; f <= whiteKingFile + 1; ++f) {
         if (f >= 0 && f < 8) {
-            uint64_t allPawnsOnFile = (board.getWhitePawns() | board.getBlackPawns()) & FILES[f];
+            uint64_t allPawnsOnFile = board.pieces(PT_PAWN) & FILES[f];
             if (!allPawnsOnFile) {
                 openFilePenalty += (f == whiteKingFile) ? 30 : 15; // King file more dangerous
             }
@@ -135,7 +134,7 @@ int evaluateKingSafety(const BitBoard &board) {
     shieldBonus = 0;
     for (int f = blackKingFile - 1; f <= blackKingFile + 1; ++f) {
         if (f >= 0 && f < 8) {
-            uint64_t fileSquares = FILES[f] & board.getBlackPawns();
+            uint64_t fileSquares = FILES[f] & board.pieces(BLACK, PT_PAWN);
             if (fileSquares) {
                 int pawnSquare = __builtin_ctzll(fileSquares);
                 int pawnRank = pawnSquare / 8;
@@ -156,7 +155,7 @@ int evaluateKingSafety(const BitBoard &board) {
     openFilePenalty = 0;
     for (int f = blackKingFile - 1; f <= blackKingFile + 1; ++f) {
         if (f >= 0 && f < 8) {
-            uint64_t allPawnsOnFile = (board.getWhitePawns() | board.getBlackPawns()) & FILES[f];
+            uint64_t allPawnsOnFile = board.pieces(PT_PAWN) & FILES[f];
             if (!allPawnsOnFile) {
                 openFilePenalty += (f == blackKingFile) ? 30 : 15;
             }
@@ -9,60 +9,137 @@ uint64_t rookMasks[64];
 uint64_t bishopAttackTable[64][4096];
 uint64_t rookAttackTable  [64][4096];
 
+#ifdef IRONFANG_PEXT
+// Dense PEXT tables: a square's slice is exactly 2^(mask bits) long, indexed by the
+// occupied mask squares squeezed together (~840 KB in all instead of 4 MB).
+static uint64_t rookPextTable[102400];
+static uint64_t bishopPextTable[5248];
+uint64_t *rookPextAttacks[64];
+uint64_t *bishopPextAttacks[64];
+#endif
+
+#ifdef IRONFANG_PEXT_DIRECT
+// the build already requires BMI2, and magic.h calls PEXT inline
+static bool cpuHasFastPext() { return true; }
+#elif defined(IRONFANG_PEXT)
+// Runtime-dispatched: these are compiled for BMI2 on their own (target attribute),
+// so the rest of the binary still runs on CPUs without it.
+__attribute__((target("bmi2")))
+static uint64_t getRookAttacksPext(int square, uint64_t occupancy) {
+    return rookPextAttacks[square][_pext_u64(occupancy, rookMasks[square])];
+}
+
+__attribute__((target("bmi2")))
+static uint64_t getBishopAttacksPext(int square, uint64_t occupancy) {
+    return bishopPextAttacks[square][_pext_u64(occupancy, bishopMasks[square])];
+}
+
+// BMI2 is there, and PEXT isn't the slow microcoded version of AMD before Zen 3
+static bool cpuHasFastPext() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("bmi2") && !__builtin_cpu_is("znver1") && !__builtin_cpu_is("znver2");
+}
+#endif
+
+#ifndef IRONFANG_PEXT_DIRECT
+static uint64_t getRookAttacksMagic(int square, uint64_t occupancy);
+static uint64_t getBishopAttacksMagic(int square, uint64_t occupancy);
+
+uint64_t (*getRookAttacks)(int square, uint64_t occupancy) = getRookAttacksMagic;
+uint64_t (*getBishopAttacks)(int square, uint64_t occupancy) = getBishopAttacksMagic;
+#endif
+
 uint64_t getBishopBlockerMask(int square);
 uint64_t getRookBlockerMask(int square);
 uint64_t setithBlocker(uint64_t mask, int index);
 uint64_t bishop_attacks(int square, uint64_t blockers);
 uint64_t rook_attacks(int square, uint64_t blockers);
 
-void initMagicTables() {
-    // Zero tables
-    memset(bishopAttackTable, 0, sizeof(bishopAttackTable));
-    memset(rookAttackTable,   0, sizeof(rookAttackTable));
+// magic hashed attacks for every occupancy of the square's mask
+static void initMagicSquare(int sq) {
+    int bishopCount = 1 << popcount(bishopMasks[sq]);
+    int rookCount   = 1 << popcount(rookMasks[sq]);
+
+    for (int idx = 0; idx < bishopCount; ++idx) {
+        uint64_t blockers = setithBlocker(bishopMasks[sq], idx);
+        uint64_t attacks  = bishop_attacks(sq, blockers);
+
+        // magic hash
+        int magicIndex = (int)((blockers * bishopMagics[sq]) >> bishopShifts[sq]);
+        bishopAttackTable[sq][magicIndex] = attacks;
+    }
+
+    for (int idx = 0; idx < rookCount; ++idx) {
+        uint64_t blockers = setithBlocker(rookMasks[sq], idx);
+        uint64_t attacks  = rook_attacks(sq, blockers);
 
+        int magicIndex = (int)((blockers * rookMagics[sq]) >> rookShifts[sq]);
+        rookAttackTable[sq][magicIndex] = attacks;
+    }
+}
+
+void initMagicTables() {
     for (int sq = 0; sq < 64; ++sq) {
-        // 1) compute and store masks
         bishopMasks[sq] = getBishopBlockerMask(sq);
         rookMasks[sq]   = getRookBlockerMask(sq);
+    }
 
-        // 2) count relevant bits
-        int bishopBits = __builtin_popcountll(bishopMasks[sq]);
-        int rookBits   = __builtin_popcountll(rookMasks[sq]);
-
-        int bishopCount = 1 << bishopBits;
-        int rookCount   = 1 << rookBits;
+#ifdef IRONFANG_PEXT
+    if (cpuHasFastPext()) {
+        uint64_t *rookNext = rookPextTable;
+        uint64_t *bishopNext = bishopPextTable;
+
+        for (int sq = 0; sq < 64; ++sq) {
+            int bishopCount = 1 << popcount(bishopMasks[sq]);
+            int rookCount   = 1 << popcount(rookMasks[sq]);
+            bishopPextAttacks[sq] = bishopNext;
+            rookPextAttacks[sq] = rookNext;
+            bishopNext += bishopCount;
+            rookNext += rookCount;
+
+            // setithBlocker(mask, idx) is the occupancy that PEXT over mask turns back into idx
+            for (int idx = 0; idx < bishopCount; ++idx) {
+                bishopPextAttacks[sq][idx] = bishop_attacks(sq, setithBlocker(bishopMasks[sq], idx));
+            }
+            for (int idx = 0; idx < rookCount; ++idx) {
+                rookPextAttacks[sq][idx] = rook_attacks(sq, setithBlocker(rookMasks[sq], idx));
+            }
+        }
+        assert(rookNext == rookPextTable + 102400 && bishopNext == bishopPextTable + 5248);
 
-        // 3) for each blocker permutation, fill attack table
-        for (int idx = 0; idx < bishopCount; ++idx) {
-            uint64_t blockers = setithBlocker(bishopMasks[sq], idx);
-            uint64_t attacks  = bishop_attacks(sq, blockers);
+#ifndef IRONFANG_PEXT_DIRECT
+        getRookAttacks = getRookAttacksPext;
+        getBishopAttacks = getBishopAttacksPext;
+#endif
+        return;
+    }
+#endif
 
-            // magic hash
-            int magicIndex = (int)((blockers * bishopMagics[sq]) >> bishopShifts[sq]);
-            bishopAttackTable[sq][magicIndex] = attacks;
-        }
+    // Zero tables
+    memset(bishopAttackTable, 0, sizeof(bishopAttackTable));
+    memset(rookAttackTable,   0, sizeof(rookAttackTable));
 
-        for (int idx = 0; idx < rookCount; ++idx) {
-            uint64_t blockers = setithBlocker(rookMasks[sq], idx);
-            uint64_t attacks  = rook_attacks(sq, blockers);
+    for (int sq = 0; sq < 64; ++sq) initMagicSquare(sq);
 
-            int magicIndex = (int)((blockers * rookMagics[sq]) >> rookShifts[sq]);
-            rookAttackTable[sq][magicIndex] = attacks;
-        }
-    }
+#ifndef IRONFANG_PEXT_DIRECT
+    getRookAttacks = getRookAttacksMagic;
+    getBishopAttacks = getBishopAttacksMagic;
+#endif
 }
 
-uint64_t getRookAttacks(int square, uint64_t occupancy) {
+#ifndef IRONFANG_PEXT_DIRECT
+static uint64_t getRookAttacksMagic(int square, uint64_t occupancy) {
     uint64_t blockers = occupancy & rookMasks[square];
     int index = (int)((blockers * rookMagics[square]) >> rookShifts[square]);
     return rookAttackTable[square][index];
 }
 
-uint64_t getBishopAttacks(int square, uint64_t occupancy) {
+static uint64_t getBishopAttacksMagic(int square, uint64_t occupancy) {
     uint64_t blockers = occupancy & bishopMasks[square];
     int index = (int)((blockers * bishopMagics[square]) >> bishopShifts[square]);
     return bishopAttackTable[square][index];
 }
+#endif
 
 uint64_t getBishopBlockerMask(int square)
 {
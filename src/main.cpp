@@ -1,8 +1,6 @@
-#include "board.h"
 #include "bitboard.h"
 #include "evaluate.h"
 #include "search.h"
-#include "mailbox.h"
 #include "uci.h"
 #include "zobrist.h"
 #include "perft.h"
@@ -0,0 +1,144 @@
+#include "movepicker.h"
+#include "evaluate.h"
+
+// above anything the history table can reach, so these always sort first within their group
+static constexpr int PROMOTION_BONUS = 1 << 24;
+static constexpr int CAPTURE_BONUS = 1 << 24;
+
+MovePicker::MovePicker(const BitBoard &board, Move ttMove, const Move *killers, const HistoryTable &history, bool inCheck)
+    : board(board), history(history), ttMove(ttMove), killers{killers[0], killers[1]},
+      stage(inCheck ? EVASION_TT : MAIN_TT) {}
+
+MovePicker::MovePicker(const BitBoard &board, Move ttMove, const HistoryTable &history, bool inCheck)
+    : board(board), history(history), ttMove(ttMove), killers{Move::none(), Move::none()},
+      stage(inCheck ? EVASION_TT : QSEARCH_TT) {}
+
+// TT moves can come from another position with the same key and killers from a sibling node,
+// so they are only played if they are legal here. Checked straight from the board, no generation.
+bool MovePicker::isValid(Move move) const {
+    return board.isPseudoLegal(move) && board.isLegal(move);
+}
+
+// MVV-LVA, plus the promoted piece
+void MovePicker::scoreCaptures() {
+    const int *value = Evaluation::pieceValue;
+    for (int i = 0; i < moves.size(); ++i) {
+        Move move = moves[i];
+        int score = value[board.capturedPiece(move) & 7] * 10 - value[board.movedPiece(move) & 7];
+        if (move.isPromotion()) score += value[move.promotionType()];
+        moves.scores[i] = score;
+    }
+}
+
+void MovePicker::scoreQuiets() {
+    for (int i = 0; i < quiets.size(); ++i) {
+        Move move = quiets[i];
+        int score = history[move.from()][move.to()];
+        if (move.isPromotion()) score += PROMOTION_BONUS + Evaluation::pieceValue[move.promotionType()];
+        quiets.scores[i] = score;
+    }
+}
+
+// captures first by MVV-LVA, then the king walks and blocks by history
+void MovePicker::scoreEvasions() {
+    const int *value = Evaluation::pieceValue;
+    for (int i = 0; i < moves.size(); ++i) {
+        Move move = moves[i];
+        if (board.isCapture(move)) {
+            moves.scores[i] = CAPTURE_BONUS + value[board.capturedPiece(move) & 7] * 10 - value[board.movedPiece(move) & 7];
+        } else {
+            moves.scores[i] = history[move.from()][move.to()];
+        }
+    }
+}
+
+Move MovePicker::next() {
+    while (true) {
+        switch (stage) {
+            case MAIN_TT:
+            case EVASION_TT:
+            case QSEARCH_TT:
+                ++stage;
+                // quiescence only plays the TT move if it is a capture
+                if (!ttMove.isNone() && isValid(ttMove) && (stage != QCAPTURE_INIT || board.isCapture(ttMove))) {
+                    return ttMove;
+                }
+                break;
+
+            case CAPTURE_INIT:
+            case QCAPTURE_INIT:
+                board.generate<GEN_CAPTURES>(moves);
+                scoreCaptures();
+                current = badCaptures = 0;
+                ++stage;
+                break;
+
+            case GOOD_CAPTURES:
+                while (current < moves.size()) {
+                    Move move = moves.pickBest(current++);
+                    if (move == ttMove) continue;
+
+                    if (!board.seeGE(move)) {
+                        moves[badCaptures++] = move;
+                        continue;
+                    }
+                    return move;
+                }
+                ++stage;
+                break;
+
+            case KILLER_1:
+            case KILLER_2: {
+                Move killer = killers[stage - KILLER_1];
+                ++stage;
+                if (!killer.isNone() && killer != ttMove && !board.isCapture(killer) && isValid(killer)) {
+                    return killer;
+                }
+                break;
+            }
+
+            case QUIET_INIT:
+                board.generate<GEN_QUIETS>(quiets);
+                scoreQuiets();
+                current = 0;
+                ++stage;
+                break;
+
+            case QUIETS:
+                while (current < quiets.size()) {
+                    Move move = quiets.pickBest(current++);
+                    if (move == ttMove || move == killers[0] || move == killers[1]) continue;
+                    return move;
+                }
+                current = 0;
+                ++stage;
+                break;
+
+            case BAD_CAPTURES:
+                if (current < badCaptures) return moves[current++];
+                stage = DONE;
+                break;
+
+            case EVASION_INIT:
+                board.generate<GEN_EVASIONS>(moves);
+                scoreEvasions();
+                current = 0;
+                ++stage;
+                break;
+
+            case EVASIONS:
+            case QCAPTURES:
+                while (current < moves.size()) {
+                    Move move = moves.pickBest(current++);
+                    if (move == ttMove) continue;
+                    return move;
+                }
+                stage = DONE;
+                break;
+
+            case DONE:
+            default:
+                return Move::none();
+        }
+    }
+}
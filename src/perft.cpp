@@ -4,25 +4,17 @@ uint64_t perft(BitBoard& board, int depth) {
     if (depth == 0) return 1;
 
     uint64_t nodes = 0;
-    std::vector<Move> moves = board.generateMoves();
+    MoveList moves;
+    board.generate<GEN_ALL>(moves);
 
-    for (Move move : moves) {
-        Gamestate prevState = {
-            board.sideToMove, 
-            board.enPassantSquare,
-            board.whiteKingsideCastle,
-            board.whiteQueensideCastle,
-            board.blackKingsideCastle,
-            board.blackQueensideCastle,
-            board.whiteKingSquare,
-            board.blackKingSquare,
-            board.zobristKey
-        };
+    // the generator is legal, so the last ply is just the length of the list
+    if (depth == 1) return moves.size();
 
-        if(!board.makeMove(move)) continue;
+    for (Move move : moves) {
+        board.makeMove(move);
 
         nodes += perft(board, depth - 1);
-        board.unmakeMove(move, prevState);
+        board.unmakeMove(move);
     }
     return nodes;
 }
\ No newline at end of file
@@ -1,30 +1,73 @@
 // search.cpp
 #include "search.h"
 #include "evaluate.h"
-#include "zobrist.h"
 #include "tt.h"
+#include "movepicker.h"
 #include <cstdint>
 #include <algorithm>
 #include <array>
 #include <chrono>
+#include <iomanip>
+#include <iostream>
 #include <assert.h>
 
-std::vector<std::vector<Move>> killerMoves(MAX_DEPTH+1, std::vector<Move>(2, Move(NONE, -1, -1)));
-std::array<std::array<int, 64>, 64> historyHeuristics{};
+std::vector<std::vector<Move>> killerMoves(MAX_DEPTH+1, std::vector<Move>(2, Move::none()));
+HistoryTable historyHeuristics{};
 TranspositionTable TT;
 
 uint64_t nodeCount = 0;
 
+static double percent(uint64_t part, uint64_t whole) {
+    return whole ? 100.0 * part / whole : 0.0;
+}
+
+// MVV-LVA, the captured piece is NONE for quiet moves
+static int mvvLva(const BitBoard &board, const Move &move) {
+    return Evaluation::pieceValue[board.capturedPiece(move) & 7] * 10 - Evaluation::pieceValue[board.movedPiece(move) & 7];
+}
+
+// quiet moves that cause a cutoff are tried earlier everywhere else in the tree, deeper cutoffs count for more.
+// The table is halved once an entry gets large so it never overflows and old cutoffs fade out.
+static void updateHistory(const Move &move, int depth) {
+    int &entry = historyHeuristics[move.from()][move.to()];
+    entry += depth * depth;
+    if (entry >= (1 << 20)) {
+        for (auto &row : historyHeuristics) {
+            for (int &h : row) h /= 2;
+        }
+    }
+}
+
+// fills moves.scores, the search loops then take moves in order with pickBest()
+template<typename ScoreFn>
+static void scoreMoves(MoveList &moves, ScoreFn score) {
+    for (int i = 0; i < moves.size(); ++i) moves.scores[i] = score(moves[i]);
+}
+
+// TT statistics for the current search, printed after every iteration in debug mode
+static void printTTStats(int depth, int hashFull) {
+    const TTStats &s = ttStats;
+    std::cout << std::fixed << std::setprecision(1)
+              << "info string tt depth " << depth
+              << " hashfull " << hashFull
+              << " probes " << s.probes
+              << " keyhit " << percent(s.keyMatches, s.probes) << "%"
+              << " cut exact " << percent(s.cutoffs[TT_EXACT], s.probes) << "%"
+              << " lower " << percent(s.cutoffs[TT_LOWER], s.probes) << "%"
+              << " upper " << percent(s.cutoffs[TT_UPPER], s.probes) << "%"
+              << " collisions " << percent(s.collisions, s.probes) << "%"
+              << " torn " << s.verifyFailures
+              << " stores " << s.stores
+              << " replaced " << percent(s.replacements, s.stores) << "%"
+              << "\n" << std::defaultfloat << std::flush;
+}
+
 Move Search::findBestMove(BitBoard& board, int maxDepth, int timeLimit) {
     // Reset counters
     nodeCount = 0;
-    TT.lookupCount = 0;
-    TT.hitCount = 0;
-    TT.keyMatchCount = 0;
-    TT.totalStoreAttempts = 0;
-    TT.actualStores = 0;
-    TT.overwritten = 0;
-    TT.currentAge++;
+    ttStats = TTStats{};
+    historyHeuristics = {};
+    TT.newSearch();
     
     // Start timing
     auto startTime = std::chrono::steady_clock::now();
@@ -34,36 +77,19 @@ Move Search::findBestMove(BitBoard& board, int maxDepth, int timeLimit) {
     int hardTimeLimit = timeLimit > 0 ? static_cast<int>(timeLimit * 0.95) : -1;
     
     // Default move (will be overwritten soon)
-    Move bestMove{NONE, -1, -1};
+    Move bestMove = Move::none();
     int bestScore = -INF;
     
     // Generate all  moves
-    std::vector<Move> moves = board.generateMoves();
+    MoveList moves;
+    board.generate<GEN_ALL>(moves);
     
     if (moves.empty()) {
-        return Move{NONE, -1, -1}; // No moves available
+        return Move::none(); // No moves available
     }
     
-    // Set a default move immediately for safety
-    for (const Move& move : moves) {
-        Gamestate prevdata = {
-            board.sideToMove,
-            board.enPassantSquare,
-            board.whiteKingsideCastle,
-            board.whiteQueensideCastle,
-            board.blackKingsideCastle,
-            board.blackQueensideCastle,
-            board.whiteKingSquare,
-            board.blackKingSquare,
-            board.zobristKey
-        };
-        
-        if (board.makeMove(move)) {
-            board.unmakeMove(move, prevdata);
-            bestMove = move; // Set default move in case we run out of time
-            break;
-        }
-    }
+    // Set a default move immediately for safety, every generated move is legal
+    bestMove = moves[0];
     
     // ------------------------------------------------------------------------------------
     //                          ITERATIVE DEEPENING SEARCH
@@ -102,48 +128,33 @@ Move Search::findBestMove(BitBoard& board, int maxDepth, int timeLimit) {
         // }
 
         // Move Ordering for Root Search
-        for(Move &move : moves) {
-            move.heuristicScore = 0;
+        scoreMoves(moves, [&](const Move &move) {
+            int score = 0;
             
             if(move==bestMove) {
-                move.heuristicScore += 5000;
+                score += 5000;
             }
             
             // 1. MVV-LVA
-            if(move.capture) {
-                move.heuristicScore += 1000 + (Evaluation::pieceValue[move.capture & 7] * 10 - Evaluation::pieceValue[move.piece & 7]);
+            if(board.isCapture(move)) {
+                score += 1000 + mvvLva(board, move);
             }
 
-            if(move.promotion) move.heuristicScore += 4000;
+            if(move.isPromotion()) score += 4000;
 
-        }
-        std::sort(moves.begin(), moves.end(), [](const Move& m1, const Move& m2) {
-            return m1.heuristicScore > m2.heuristicScore;
+            return score;
         });
 
         
         // Search all moves at this depth
-        for (const Move& move : moves) {
-            Gamestate prevdata = {
-                board.sideToMove,
-                board.enPassantSquare,
-                board.whiteKingsideCastle,
-                board.whiteQueensideCastle,
-                board.blackKingsideCastle,
-                board.blackQueensideCastle,
-                board.whiteKingSquare,
-                board.blackKingSquare,
-                board.zobristKey
-            };
-            
-            if (!board.makeMove(move)) {
-                continue;
-            }
+        for (int i = 0; i < moves.size(); ++i) {
+            Move move = moves.pickBest(i);
+            board.makeMove(move);
             board.pathDepth = 0;
             // Normal search with full alpha-beta window
             int score = -minimaxAlphaBeta(board, depth - 1, -beta, -alpha, 0);
             
-            board.unmakeMove(move, prevdata);
+            board.unmakeMove(move);
             
             // Check if this is a better move
             if (score > iterationBestScore) {
@@ -191,18 +202,9 @@ Move Search::findBestMove(BitBoard& board, int maxDepth, int timeLimit) {
                   << " nps " << nps
                   << " pv " << moveToUCI(bestMove) << "\n" << std::flush;
 
-        // // TT - stats
-        // std::cout << "info string TT: depth=" << depth
-        //   << " occ=" << TT.entriesOccupied
-        //   << " (" << (100.0 * TT.entriesOccupied / TT_SIZE) << "%)"
-        //   << " hits=" << TT.hitCount
-        //   << " lookups=" << TT.lookupCount
-        //   << " hitrate=" << (100.0 * TT.hitCount / std::max(TT.lookupCount, (uint64_t)1ull)) << "%"
-        //   << " Key matches=" << (100.0 * TT.keyMatchCount / std::max(TT.lookupCount, (uint64_t)1ull)) << "%"
-        //   << " overwrites=" << TT.overwritten
-        //   << " stores=" << TT.actualStores
-        //   << std::endl;
-
+        if (TranspositionTable::statsEnabled) {
+            printTTStats(depth, hashFull);
+        }
           
     }
 
@@ -224,7 +226,7 @@ int Search::minimaxAlphaBeta(BitBoard& board, int depth, int alpha, int beta, in
     }
 
     // before doing anything check T-table
-    Move tempMove = Move(NONE, -1, -1);
+    Move tempMove = Move::none();
     int tempEval;
 
     if(TT.probe(board.zobristKey, depth, alpha, beta, tempEval, tempMove)) {
@@ -232,33 +234,11 @@ int Search::minimaxAlphaBeta(BitBoard& board, int depth, int alpha, int beta, in
         return tempEval;
     }
 
-    int kingSq = (board.sideToMove == WHITE) ? board.whiteKingSquare : board.blackKingSquare;
-    Color opponent = (board.sideToMove == WHITE) ? BLACK : WHITE;
-    bool inCheck = board.isSquareAttacked(kingSq, opponent);
+    bool inCheck = board.checkers() != 0;
 
     if (depth >= 3 && !inCheck && hasNonPawnMaterial(board, board.sideToMove) &&
     beta < MATE_THRESHOLD && alpha > -MATE_THRESHOLD) {
-        // snapshot all mutable state
-        Gamestate prevState = {
-            board.sideToMove,
-            board.enPassantSquare,
-            board.whiteKingsideCastle,
-            board.whiteQueensideCastle,
-            board.blackKingsideCastle,
-            board.blackQueensideCastle,
-            board.whiteKingSquare,
-            board.blackKingSquare,
-            board.zobristKey
-        };
-
-        // apply null move
-        board.sideToMove = (prevState.sideToMove == WHITE ? BLACK : WHITE);
-        board.zobristKey ^= zobristBlackToMove;
-        if (prevState.enPassantSquare != -1) {
-            int epFile = prevState.enPassantSquare & 7;
-            board.zobristKey ^= zobristEnPassant[epFile];
-        }
-        board.enPassantSquare = -1;
+        board.makeNullMove();
 
         // reduced-depth, null-window search
         int R = (depth > 6 ? 3 : 2);
@@ -270,20 +250,11 @@ int Search::minimaxAlphaBeta(BitBoard& board, int depth, int alpha, int beta, in
             ply+1
         );
 
-        // restore *everything*
-        board.sideToMove           = prevState.sideToMove;
-        board.enPassantSquare      = prevState.enPassantSquare;
-        board.whiteKingsideCastle  = prevState.whiteKingsideCastle;
-        board.whiteQueensideCastle = prevState.whiteQueensideCastle;
-        board.blackKingsideCastle  = prevState.blackKingsideCastle;
-        board.blackQueensideCastle = prevState.blackQueensideCastle;
-        board.whiteKingSquare      = prevState.whiteKingSquare;
-        board.blackKingSquare      = prevState.blackKingSquare;
-        board.zobristKey           = prevState.zobristKey;
+        board.unmakeNullMove();
 
         // prune on fail-high
         if (nullMoveScore >= beta) {
-            TT.store(board.zobristKey, depth, beta, TT_LOWER, Move(NONE, -1, -1));
+            TT.store(board.zobristKey, depth, beta, TT_LOWER, Move::none());
             --board.pathDepth;
             return beta;
         }
@@ -297,80 +268,26 @@ int Search::minimaxAlphaBeta(BitBoard& board, int depth, int alpha, int beta, in
 
     
 
-    std::vector<Move> moves = board.generateMoves();
-    if (moves.empty()) {
-        // No pseudo‐legal moves at all → either checkmate or stalemate
-        int kingSq = (board.sideToMove == WHITE)
-                       ? board.whiteKingSquare
-                       : board.blackKingSquare;
-        Color opp = (board.sideToMove == WHITE) ? BLACK : WHITE;
-
-        if (board.isSquareAttacked(kingSq, opp)) {
-            // Checkmate: encode ply distance so mate in 1 is better than mate in 2
-            --board.pathDepth;
-            return -INF + ply;
-        }
-        --board.pathDepth;
-        return 0; // stalemate
-    }
-
-    // Move Ordering
-    for(Move &move : moves) {
-
-        move.heuristicScore = 0;
-        int score = 0;
-
-        if(move.capture) {
-            score += 1000 + (Evaluation::pieceValue[move.capture & 7] * 10 - Evaluation::pieceValue[move.piece & 7]);
-        }
-        if(move == tempMove) {
-            score += 15000;
-        }
-        if(move.promotion) score += 5000;
-
-        if(move == killerMoves[depth][0]) score += 10000;
-        if(move == killerMoves[depth][1]) score += 9000;
-
-
-        move.heuristicScore = score;
-    }
-
-    // sort it in descending
-    std::sort(moves.begin(), moves.end(), [](const Move &m1, const Move &m2) {
-        return m1.heuristicScore > m2.heuristicScore;
-    });
-
-    bool foundLegalMove = false;
-
     int originalAlpha = alpha;
-    Move bestMove(NONE, -1, -1);
+    Move bestMove = Move::none();
 
+    // moves come out of the picker best guess first, nothing is generated until it is needed
+    MovePicker picker(board, tempMove, killerMoves[depth].data(), historyHeuristics, inCheck);
+    Move move;
 
     int moveIndex = 0;
-    for (const Move& move : moves) {
-        Gamestate prevdata = {
-            board.sideToMove,
-            board.enPassantSquare,
-            board.whiteKingsideCastle,
-            board.whiteQueensideCastle,
-            board.blackKingsideCastle,
-            board.blackQueensideCastle,
-            board.whiteKingSquare,
-            board.blackKingSquare,
-            board.zobristKey
-        };
+    while (!(move = picker.next()).isNone()) {
+        bool isCapture = board.isCapture(move);
 
         // uint64_t originalKey = board.zobristKey;
-        if (!board.makeMove(move)) {
-            continue;
-        }
-        foundLegalMove = true;
-        
+        // the child probes the TT straight away, start fetching its cluster now
+        TT.prefetch(board.keyAfter(move));
+        board.makeMove(move);
 
         int score;
         
         // Late Move Reduction
-        bool isReducible = !inCheck && !move.capture &&
+        bool isReducible = !inCheck && !isCapture &&
                     move != killerMoves[depth][0] &&
                     move != killerMoves[depth][1];
 
@@ -392,7 +309,7 @@ int Search::minimaxAlphaBeta(BitBoard& board, int depth, int alpha, int beta, in
             // Regular search for important moves
             score = -minimaxAlphaBeta(board, depth - 1, -beta, -alpha, ply+1);
         }
-        board.unmakeMove(move, prevdata);
+        board.unmakeMove(move);
         ++moveIndex;
         // assert(board.zobristKey == originalKey);
 
@@ -400,10 +317,11 @@ int Search::minimaxAlphaBeta(BitBoard& board, int depth, int alpha, int beta, in
         if (score >= beta) {
         
             // record KILLER moves here (nice name)
-            if(!move.capture && !(move == killerMoves[depth][0])) {
+            if(!isCapture && !(move == killerMoves[depth][0])) {
                 killerMoves[depth][1] = killerMoves[depth][0];
                 killerMoves[depth][0] = move;
             }
+            if (!isCapture) updateHistory(move, depth);
 
 
             // record a lower bound entry in TT
@@ -419,18 +337,12 @@ int Search::minimaxAlphaBeta(BitBoard& board, int depth, int alpha, int beta, in
         }
     }
 
-    //  there were pseudo‐legal moves but none was actually legal
-    if (!foundLegalMove) {
-        int kingSq = (board.sideToMove == WHITE)
-                       ? board.whiteKingSquare
-                       : board.blackKingSquare;
-        Color opp = (board.sideToMove == WHITE) ? BLACK : WHITE;
+    if (moveIndex == 0) {
+        // No legal moves → either checkmate or stalemate
+        // Checkmate: encode ply distance so mate in 1 is better than mate in 2
+        int eval = inCheck ? -INF + ply : 0;
 
-        int eval = board.isSquareAttacked(kingSq, opp)
-        ? -INF + ply  // checkmate
-        : 0;             // stalemate
-
-        TT.store(board.zobristKey, depth, eval, TT_EXACT, Move(NONE, -1, -1));
+        TT.store(board.zobristKey, depth, eval, TT_EXACT, Move::none());
         --board.pathDepth;
         return eval;
     }
@@ -451,87 +363,78 @@ int Search::minimaxAlphaBeta(BitBoard& board, int depth, int alpha, int beta, in
 int Search::quiescenceSearch(BitBoard& board, int alpha, int beta, int qdepth, int ply) {
     ++nodeCount;
 
-    Move probeMove;
+    Move probeMove = Move::none();
     int probeEval;
-    if (TT.probe(board.zobristKey, -qdepth, alpha, beta, probeEval, probeMove)) {
+    int probeStaticEval = TT_EVAL_NONE;
+    if (TT.probe(board.zobristKey, -qdepth, alpha, beta, probeEval, probeMove, &probeStaticEval)) {
         return probeEval;
     }
     
     // 1. More aggressive depth limit
     if (qdepth >= 6) { 
-        int eval = Evaluation::evaluate(board);
-        TT.store(board.zobristKey, -qdepth, eval, TT_EXACT, Move(NONE, -1, -1));
+        int eval = probeStaticEval != TT_EVAL_NONE ? probeStaticEval : Evaluation::evaluate(board);
+        TT.store(board.zobristKey, -qdepth, eval, TT_EXACT, Move::none(), eval);
         return eval;
     }
     
-    // 2. Stand pat evaluation
-    int standPat = Evaluation::evaluate(board);
-    
-    // Stand pat cutoff
-    if (standPat >= beta) {
-        // Store lower bound in TT
-        TT.store(board.zobristKey, -qdepth, beta, TT_LOWER, Move(NONE, -1, -1));
-        return beta;
-    }
-    
-    // Update alpha if stand pat is better
-    if (alpha < standPat)
-        alpha = standPat;
-    
-    // Generate capture moves
-    std::vector<Move> captures = board.generateCaptures();
+    // 2. In check there is no standing pat: every evasion is searched, and none at all is mate
+    bool inCheck = board.checkers() != 0;
 
+    // Stand pat evaluation, reusing the one cached in the TT if we have it
+    int staticEval = TT_EVAL_NONE;
+    int standPat = alpha;
 
-    for(Move &move : captures) {
-        if(move == probeMove) {
-            move.heuristicScore += 15000;
+    if (!inCheck) {
+        staticEval = probeStaticEval != TT_EVAL_NONE ? probeStaticEval : Evaluation::evaluate(board);
+        standPat = staticEval;
+    
+        // Stand pat cutoff
+        if (standPat >= beta) {
+            // Store lower bound in TT
+            TT.store(board.zobristKey, -qdepth, beta, TT_LOWER, Move::none(), staticEval);
+            return beta;
         }
-        if(move.promotion) move.heuristicScore += 5000;
-        move.heuristicScore += 1000 + Evaluation::pieceValue[move.capture & 7] * 10 - Evaluation::pieceValue[move.piece & 7];
-    }
     
+        // Update alpha if stand pat is better
+        if (alpha < standPat)
+            alpha = standPat;
+    }
+
+
     // 4. delta pruning
     const int FUTILITY_MARGIN = 250;
     
-    // Order captures by MVV-LVA
-    std::sort(captures.begin(), captures.end(), [](const Move& a, const Move& b) {
-        return a.heuristicScore > b.heuristicScore;
-    });
-    
-    Move bestMove(NONE, -1, -1);
-    
-    for (const Move& move : captures) {
+    // captures (or evasions) best guess first, the TT move before anything is generated
+    MovePicker picker(board, probeMove, historyHeuristics, inCheck);
+    Move move;
+
+    Move bestMove = Move::none();
+    int moveCount = 0;
+
+    while (!(move = picker.next()).isNone()) {
+        ++moveCount;
+        int capturedValue = Evaluation::pieceValue[board.capturedPiece(move) & 7];
+
         // Delta pruning - skip captures that can't improve alpha
-        if (standPat + Evaluation::pieceValue[move.capture & 7] + FUTILITY_MARGIN <= alpha) {
+        if (!inCheck && standPat + capturedValue + FUTILITY_MARGIN <= alpha) {
             continue;
         }
         
-        // Skip obviously bad captures (losing material)
-        if (Evaluation::pieceValue[move.capture & 7] < Evaluation::pieceValue[move.piece & 7] - 100) {
+        // Skip captures that lose material once the exchange is played out
+        if (!inCheck && !board.seeGE(move)) {
             continue;
         }
         
-        Gamestate prevdata = {
-            board.sideToMove,
-            board.enPassantSquare,
-            board.whiteKingsideCastle,
-            board.whiteQueensideCastle,
-            board.blackKingsideCastle,
-            board.blackQueensideCastle,
-            board.whiteKingSquare,
-            board.blackKingSquare,
-            board.zobristKey
-        };
         
-        if (!board.makeMove(move))
-            continue;
+        TT.prefetch(board.keyAfter(move));
+        board.makeMove(move);
             
         int score = -quiescenceSearch(board, -beta, -alpha, qdepth + 1, ply+1);
-        board.unmakeMove(move, prevdata);
+        board.unmakeMove(move);
         
         if (score >= beta) {
             // Store lower bound in TT
-            TT.store(board.zobristKey, -qdepth, beta, TT_LOWER, move);
+            TT.store(board.zobristKey, -qdepth, beta, TT_LOWER, move, staticEval);
             return beta;
         }
             
@@ -540,20 +443,16 @@ int Search::quiescenceSearch(BitBoard& board, int alpha, int beta, int qdepth, i
             bestMove = move;
         }
     }
+
+    if (inCheck && moveCount == 0) return -INF + ply;
     
     TT_FLAG finalFlag = (alpha > standPat) ? TT_EXACT : TT_UPPER;
-    TT.store(board.zobristKey, -qdepth, alpha, finalFlag, bestMove);
+    TT.store(board.zobristKey, -qdepth, alpha, finalFlag, bestMove, staticEval);
 
     return alpha;
 }
 
 // Helper function to detect positions where null-move is unsafe
 bool Search::hasNonPawnMaterial(const BitBoard& board, Color side) {
-    if (side == WHITE) {
-        return board.getWhiteKnights() || board.getWhiteBishops() || 
-               board.getWhiteRooks() || board.getWhiteQueens();
-    } else {
-        return board.getBlackKnights() || board.getBlackBishops() || 
-               board.getBlackRooks() || board.getBlackQueens();
-    }
+    return board.pieces(side) & ~board.pieces(PT_PAWN, PT_KING);
 }
\ No newline at end of file
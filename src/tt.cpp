@@ -1,126 +1,625 @@
 #include "tt.h"
+#include "search.h"
+#include "zobrist.h"
+#include <cstdio>
 #include <cstring>
-#include "algorithm"
+#include <algorithm>
+#include <new>
+#include <climits>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <iterator>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && !defined(__ANDROID__)
+#include <sys/file.h>
+#define TT_HAS_SHARED_MEMORY 1
+#else
+#define TT_HAS_SHARED_MEMORY 0
+#endif
+
+// Saved table layout: a TTFileHeader padded to TT_FILE_HEADER_SIZE bytes (so the
+// clusters that follow stay page aligned and can be mapped directly), then the raw clusters.
+// Bump TT_FILE_VERSION whenever TTData packing or the score encoding changes.
+static constexpr char TT_FILE_MAGIC[8] = {'I', 'F', 'H', 'A', 'S', 'H', '\0', '\0'};
+static constexpr char TT_SHARED_MAGIC[8] = {'I', 'F', 'S', 'H', 'A', 'R', 'E', 'D'}; // same header, shared segment
+static constexpr uint32_t TT_FILE_VERSION = 2;
+static constexpr size_t TT_FILE_HEADER_SIZE = 4096;
+
+struct TTFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t entrySize;
+    uint32_t clusterSize;
+    std::atomic<int32_t> generation;   // in a shared segment, the clock every attached process searches by
+    uint64_t numClusters;
+    uint64_t zobristSeed;
+    uint64_t zobristFingerprint;
+};
+static_assert(sizeof(std::atomic<int32_t>) == sizeof(int32_t) && std::atomic<int32_t>::is_always_lock_free,
+              "the header generation is read as a plain int32 from files and shared between processes");
+
+static constexpr size_t HUGE_PAGE_SIZE = 2 << 20;
+
+bool TranspositionTable::statsEnabled = false;
+thread_local TTStats ttStats;
 
 TranspositionTable::TranspositionTable()
 {
-    for (size_t i = 0; i < TT_SIZE; ++i)
-    table[i] = TTEntry{};
-    // setting all keys to zero indicating empty
     currentAge = 0;
+    clearThreads = std::clamp(static_cast<int>(std::thread::hardware_concurrency()), 1, TT_MAX_CLEAR_THREADS);
+    resize(TT_DEFAULT_MB);
+}
+
+TranspositionTable::~TranspositionTable()
+{
+    release();
+}
+
+// largest power of two number of clusters that fits in the budget
+static size_t clustersFor(size_t megabytes)
+{
+    size_t clusters = 1;
+    while (clusters * 2 * sizeof(TTCluster) <= (megabytes << 20))
+        clusters *= 2;
+    return clusters;
+}
+
+void TranspositionTable::resize(size_t megabytes)
+{
+    configuredMB = std::clamp(megabytes, TT_MIN_MB, TT_MAX_MB);
+
+    if (!sharedName.empty()) {
+        std::string error;
+        if (attachShared(sharedName, error)) return;
+        sharedName.clear();
+    }
+
+    size_t clusters = clustersFor(configuredMB);
+
+    release();
+
+    // if the request cannot be satisfied, settle for the largest table we can get
+    while (!allocate(clusters) && clusters > 1)
+        clusters /= 2;
+
+    clear();
+}
+
+// Tries huge pages first (HugeTLB, then transparent huge pages), then an ordinary
+// allocation. The memory is left untouched, resize() clears it.
+bool TranspositionTable::allocate(size_t clusters)
+{
+    size_t bytes = clusters * sizeof(TTCluster);
+
+#if defined(__linux__)
+    // HugeTLB mappings must be a whole number of huge pages
+    size_t hugeBytes = (bytes + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+    void *mem = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+    mem = mmap(nullptr, hugeBytes, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (mem != MAP_FAILED) {
+        mapBase = mem;
+        mapBytes = hugeBytes;
+        table = static_cast<TTCluster*>(mem);
+        tableBacking = TT_BACKING_HUGETLB;
+    }
+#endif
+
+    if (mem == MAP_FAILED) {
+        // over-map by one huge page so the table can start on a huge page boundary,
+        // which is what lets the kernel back it with transparent huge pages
+        size_t length = hugeBytes + HUGE_PAGE_SIZE;
+        mem = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mem != MAP_FAILED) {
+            uintptr_t aligned = (reinterpret_cast<uintptr_t>(mem) + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+            mapBase = mem;
+            mapBytes = length;
+            table = reinterpret_cast<TTCluster*>(aligned);
+            tableBacking = TT_BACKING_MMAP;
+#ifdef MADV_HUGEPAGE
+            if (madvise(table, hugeBytes, MADV_HUGEPAGE) == 0)
+                tableBacking = TT_BACKING_THP;
+#endif
+        }
+    }
+#endif
+
+    if (!table) {
+        table = new (std::nothrow) TTCluster[clusters];
+        if (!table) return false;
+        tableBacking = TT_BACKING_HEAP;
+    }
+
+    numClusters = clusters;
+    mask = clusters - 1;
+    return true;
 }
 
-bool TranspositionTable::probe(uint64_t zobristKey, int depth, int alpha, int beta, int &outEval, Move &outMove)
+void TranspositionTable::release()
 {
-    ++lookupCount;
+    if (tableBacking == TT_BACKING_HEAP) {
+        delete[] table;
+    }
+#if defined(__linux__)
+    else if (mapBase) {
+        munmap(mapBase, mapBytes);
+    }
+#endif
+
+    sharedGeneration = nullptr;
+    table = nullptr;
+    tableBacking = TT_BACKING_NONE;
+    mapBase = nullptr;
+    mapBytes = 0;
+    numClusters = 0;
+    mask = 0;
+}
+
+bool TranspositionTable::setShared(const std::string &name, std::string &error)
+{
+    error.clear();
+    if (name.empty()) {
+        if (isShared()) {
+            sharedName.clear();
+            resize(configuredMB);
+        }
+        return true;
+    }
+
+    if (!attachShared(name, error)) return false;
+    sharedName = name;
+    return true;
+}
+
+// The segment starts with the same header as a saved table (with its own magic), followed
+// by the clusters. Entries are lockless and std::atomic<uint64_t> is address free, so every
+// attached process can probe and store concurrently without further coordination.
+// flock() is only held while setting up and is dropped by the kernel if we die holding it;
+// a crash at any other point leaves nothing to recover since there is no lock to release.
+// The segment outlives all processes until it is removed (e.g. rm /dev/shm/<name>).
+bool TranspositionTable::attachShared(const std::string &name, std::string &error)
+{
+#if TT_HAS_SHARED_MEMORY
+    std::string shmName = (name[0] == '/') ? name : "/" + name;
+    int fd = shm_open(shmName.c_str(), O_RDWR | O_CREAT, 0600);
+    if (fd < 0) {
+        error = "cannot open shared memory " + shmName;
+        return false;
+    }
+    flock(fd, LOCK_EX);
+
+    struct stat st;
+    size_t length = 0;
+    if (fstat(fd, &st) == 0) {
+        length = static_cast<size_t>(st.st_size);
+        if (length == 0) {
+            // fresh segment, ftruncate zero-fills it, i.e. an empty table
+            length = TT_FILE_HEADER_SIZE + clustersFor(configuredMB) * sizeof(TTCluster);
+            if (ftruncate(fd, length) != 0) length = 0;
+        }
+    }
+
+    void *mem = (length > TT_FILE_HEADER_SIZE)
+              ? mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+              : MAP_FAILED;
 
-    size_t index = zobristKey & TT_MASK;
-    TTEntry &entry = table[index];
+    TTFileHeader *header = (mem != MAP_FAILED) ? static_cast<TTFileHeader*>(mem) : nullptr;
+    uint64_t clusters = (length - TT_FILE_HEADER_SIZE) / sizeof(TTCluster);
+
+    if (!header) {
+        error = "cannot map shared memory " + shmName;
+    }
+    else if (header->magic[0] == '\0') {
+        // we created it, or whoever did died before finishing; the size is already set
+        if ((clusters & (clusters - 1)) != 0 || TT_FILE_HEADER_SIZE + clusters * sizeof(TTCluster) != length) {
+            error = shmName + " has an unexpected size";
+        }
+        else {
+            std::memcpy(header->magic, TT_SHARED_MAGIC, sizeof(header->magic));
+            header->version            = TT_FILE_VERSION;
+            header->entrySize          = sizeof(TTEntry);
+            header->clusterSize        = TT_CLUSTER_SIZE;
+            header->generation         = currentAge;
+            header->numClusters        = clusters;
+            header->zobristSeed        = ZOBRIST_SEED;
+            header->zobristFingerprint = zobristFingerprint();
+        }
+    }
+    else if (std::memcmp(header->magic, TT_SHARED_MAGIC, sizeof(header->magic)) != 0
+             || header->version != TT_FILE_VERSION || header->entrySize != sizeof(TTEntry)
+             || header->clusterSize != TT_CLUSTER_SIZE || header->numClusters != clusters
+             || header->zobristSeed != ZOBRIST_SEED || header->zobristFingerprint != zobristFingerprint()) {
+        error = shmName + " was created by an incompatible engine build";
+    }
+
+    flock(fd, LOCK_UN);
+    close(fd);
+
+    if (!error.empty()) {
+        if (header) munmap(mem, length);
+        return false;
+    }
+
+    release();
+    mapBase = mem;
+    mapBytes = length;
+    table = reinterpret_cast<TTCluster*>(static_cast<char*>(mem) + TT_FILE_HEADER_SIZE);
+    tableBacking = TT_BACKING_SHARED;
+
+    // from now on generations come from the segment, so all processes agree on which entries are current
+    sharedGeneration = &header->generation;
+    currentAge = sharedGeneration->load(std::memory_order_relaxed);
+    numClusters = clusters;
+    mask = clusters - 1;
+    return true;
+#else
+    (void)name;
+    error = "shared memory is not supported on this platform";
+    return false;
+#endif
+}
+
+bool TranspositionTable::save(const std::string &path, std::string &error) const
+{
+    TTFileHeader header{};
+    std::memcpy(header.magic, TT_FILE_MAGIC, sizeof(header.magic));
+    header.version            = TT_FILE_VERSION;
+    header.entrySize          = sizeof(TTEntry);
+    header.clusterSize        = TT_CLUSTER_SIZE;
+    header.generation         = sharedGeneration ? sharedGeneration->load(std::memory_order_relaxed) : currentAge;
+    header.numClusters        = numClusters;
+    header.zobristSeed        = ZOBRIST_SEED;
+    header.zobristFingerprint = zobristFingerprint();
+
+    // Written next to path and renamed over it: the table may be a mapping of path itself (after
+    // load), and truncating that file would pull the unwritten pages out from under the search.
+    std::string tmpPath = path + ".tmp";
+    std::FILE *file = std::fopen(tmpPath.c_str(), "wb");
+    if (!file) {
+        error = "cannot open " + tmpPath + " for writing";
+        return false;
+    }
+
+    char padding[TT_FILE_HEADER_SIZE] = {};
+    std::memcpy(padding, &header, sizeof(header));
+
+    bool ok = std::fwrite(padding, 1, sizeof(padding), file) == sizeof(padding)
+           && std::fwrite(static_cast<const void*>(table), sizeof(TTCluster), numClusters, file) == numClusters;
+    ok = (std::fclose(file) == 0) && ok;
+
+    if (!ok) {
+        std::remove(tmpPath.c_str());
+        error = "failed writing " + tmpPath;
+        return false;
+    }
+
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+#if defined(_WIN32)
+        // rename() won't replace an existing file here, and nothing maps it on this platform
+        if (std::remove(path.c_str()) == 0 && std::rename(tmpPath.c_str(), path.c_str()) == 0) return true;
+#endif
+        std::remove(tmpPath.c_str());
+        error = "cannot replace " + path;
+        return false;
+    }
+    return true;
+}
+
+bool TranspositionTable::load(const std::string &path, std::string &error)
+{
+    error.clear();
+    std::FILE *file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    TTFileHeader header{};
+    bool readHeader = std::fread(&header, sizeof(header), 1, file) == 1;
+    std::fseek(file, 0, SEEK_END);
+    long fileSize = std::ftell(file);
+
+    if (!readHeader || std::memcmp(header.magic, TT_FILE_MAGIC, sizeof(header.magic)) != 0)
+        error = path + " is not a saved hash table";
+    else if (header.version != TT_FILE_VERSION || header.entrySize != sizeof(TTEntry)
+             || header.clusterSize != TT_CLUSTER_SIZE)
+        error = path + " uses an incompatible entry layout";
+    else if (header.zobristSeed != ZOBRIST_SEED || header.zobristFingerprint != zobristFingerprint())
+        error = path + " was written with different zobrist keys";
+    else if (header.numClusters == 0 || (header.numClusters & (header.numClusters - 1)) != 0
+             || fileSize < 0
+             || static_cast<uint64_t>(fileSize) != TT_FILE_HEADER_SIZE + header.numClusters * sizeof(TTCluster))
+        error = path + " is truncated or corrupt";
+
+    if (!error.empty()) {
+        std::fclose(file);
+        return false;
+    }
+
+#if defined(__linux__)
+    // map the file copy-on-write: pages come in lazily as they are probed and
+    // stores never touch the file, so loading is near instant even for huge tables
+    std::fclose(file);
+    int fd = open(path.c_str(), O_RDONLY);
+    void *mem = (fd >= 0) ? mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    if (fd >= 0) close(fd);
+
+    if (mem == MAP_FAILED) {
+        error = "cannot map " + path;
+        return false;
+    }
+
+    release();
+    mapBase = mem;
+    mapBytes = fileSize;
+    table = reinterpret_cast<TTCluster*>(static_cast<char*>(mem) + TT_FILE_HEADER_SIZE);
+    tableBacking = TT_BACKING_FILE;
+#else
+    TTCluster *loaded = new (std::nothrow) TTCluster[header.numClusters];
+    bool ok = loaded
+           && std::fseek(file, TT_FILE_HEADER_SIZE, SEEK_SET) == 0
+           && std::fread(static_cast<void*>(loaded), sizeof(TTCluster), header.numClusters, file) == header.numClusters;
+    std::fclose(file);
+    if (!ok) {
+        error = "failed reading " + path;
+        delete[] loaded;
+        return false;
+    }
+
+    release();
+    table = loaded;
+    tableBacking = TT_BACKING_HEAP;
+#endif
+
+    numClusters = header.numClusters;
+    mask = numClusters - 1;
+    sharedName.clear();
+
+    // findBestMove bumps the age before searching, so this makes the next search run
+    // in the saved generation and the loaded entries are not the first to be replaced
+    currentAge = header.generation - 1;
+    return true;
+}
+
+const char *TranspositionTable::backingName() const
+{
+    switch (tableBacking) {
+        case TT_BACKING_HUGETLB: return "huge pages (MAP_HUGETLB)";
+        case TT_BACKING_THP:     return "transparent huge pages (madvise)";
+        case TT_BACKING_MMAP:    return "regular pages (mmap)";
+        case TT_BACKING_HEAP:    return "regular pages (heap)";
+        case TT_BACKING_FILE:    return "a mapped hash file";
+        case TT_BACKING_SHARED:  return "shared memory";
+        default:                 return "none";
+    }
+}
+
+// Scores are stored in 16 bits. Mate scores (-INF + ply) are far outside that range,
+// so they are re-based onto [TT_MATE - 1000, TT_MATE] keeping their distance to INF.
+static constexpr int TT_MATE = 32000;
+static constexpr int TT_MAX_MATE_DISTANCE = 1000;
+static constexpr int TT_MAX_EVAL = TT_MATE - TT_MAX_MATE_DISTANCE - 1;
+
+static inline int16_t encodeScore(int score) {
+    if (score > MATE_THRESHOLD)
+        return static_cast<int16_t>(TT_MATE - std::min(INF - score, TT_MAX_MATE_DISTANCE));
+    if (score < -MATE_THRESHOLD)
+        return static_cast<int16_t>(-TT_MATE + std::min(INF + score, TT_MAX_MATE_DISTANCE));
+    return static_cast<int16_t>(std::clamp(score, -TT_MAX_EVAL, TT_MAX_EVAL));
+}
+
+static inline int decodeScore(int16_t stored) {
+    if (stored > TT_MAX_EVAL)  return INF - (TT_MATE - stored);
+    if (stored < -TT_MAX_EVAL) return -INF + (TT_MATE + stored);
+    return stored;
+}
+
+bool TranspositionTable::probe(uint64_t zobristKey, int depth, int alpha, int beta, int &outEval, Move &outMove, int *outStaticEval)
+{
+    size_t index = zobristKey & mask;
+    TTCluster &cluster = table[index];
+    if (statsEnabled) ++ttStats.probes;
+
+    for (TTEntry &slot : cluster.entries) {
+        uint64_t word = slot.loadData();
+        uint64_t key = slot.key(word);
+
+        // ABSOLUTELY DONT MESS AROUND HERE
+        // a torn or foreign entry fails this check
+        if (key != zobristKey) {
+            // a key that doesn't even belong in this cluster can only come from a torn write
+            if (statsEnabled && key != 0 && (key & mask) != index) ++ttStats.verifyFailures;
+            continue;
+        }
+
+        // entries from earlier searches (previous moves, pondering) are just as valid
+        // for this position, the generation only matters when choosing what to replace
+        TTData entry = TTData::unpack(word);
+        if (statsEnabled) ++ttStats.keyMatches;
 
-    // ABSOLUTELY DONT MESS AROUND HERE
-    if (entry.key == zobristKey && entry.age == currentAge) {
-        ++keyMatchCount;
         // Always extract the move if it's the correct position
-        outMove = entry.bestMove;
+        outMove = Move(entry.move);
+        if (outStaticEval) *outStaticEval = entry.staticEval;
 
         // Check if stored depth is enough
-        if (entry.depth >= depth) {
-            switch(entry.flag) {
-                case TT_EXACT:
-                    ++hitCount;
-                    outEval = entry.eval;
-                    return true;
-                case TT_LOWER:
-                    if (entry.eval >= beta) {
-                        ++hitCount;
-                        outEval = entry.eval;
-                        return true;
-                    }
-                    break;
-                case TT_UPPER:
-                    if (entry.eval <= alpha) {
-                        ++hitCount;
-                        outEval = entry.eval;
-                        return true;
-                    }
-                    break;
-            }
+        if (entry.depth < depth) return false;
+
+        int eval = decodeScore(entry.eval);
+        bool cutoff = false;
+        switch(entry.flag()) {
+            case TT_EXACT: cutoff = true;          break;
+            case TT_LOWER: cutoff = (eval >= beta);  break;
+            case TT_UPPER: cutoff = (eval <= alpha); break;
         }
+
+        if (cutoff) {
+            if (statsEnabled) ++ttStats.cutoffs[entry.flag()];
+            outEval = eval;
+        }
+        return cutoff;
     }
 
+    if (statsEnabled) {
+        bool full = std::all_of(std::begin(cluster.entries), std::end(cluster.entries),
+                                [](const TTEntry &slot) { return slot.key(slot.loadData()) != 0; });
+        if (full) ++ttStats.collisions;
+    }
     return false;
 }
 
 
+void TranspositionTable::newSearch()
+{
+    if (sharedGeneration) currentAge = sharedGeneration->fetch_add(1, std::memory_order_relaxed) + 1;
+    else ++currentAge;
+}
+
 void TranspositionTable::store(uint64_t zobristKey, int depth, int eval,
-                               TT_FLAG flag, const Move &bestMove)
+                               TT_FLAG flag, const Move &bestMove, int staticEval)
 {
-    ++totalStoreAttempts;
-    size_t index = zobristKey & TT_MASK;
-    TTEntry &entry = table[index];
+    if (statsEnabled) ++ttStats.stores;
+    TTCluster &cluster = table[zobristKey & mask];
 
-    bool isOverwrite = (entry.key != 0 && entry.key != zobristKey);
+    int generation = currentGeneration();
+    uint16_t move = bestMove.raw();
 
-    // Prevent quiescence (depth<0) from wiping out real searches
-    if (depth < 0 && entry.depth > 0 && entry.key != zobristKey)
-        return;
+    // Pick the slot: the entry for this position if there is one, otherwise an empty
+    // entry, otherwise the least valuable one (shallowest once older generations are penalised)
+    TTEntry *replace = &cluster.entries[0];
+    uint64_t replaceWord = replace->loadData();
+    uint64_t replaceKey = replace->key(replaceWord);
+    int replaceScore = INT32_MAX;
+    bool sameKey = false;
 
-    // --- start replacement-policy patch ---
-    bool shouldReplace = false;
+    for (TTEntry &slot : cluster.entries) {
+        uint64_t word = slot.loadData();
+        uint64_t key = slot.key(word);
+
+        if (key == zobristKey) {
+            replace = &slot;
+            replaceWord = word;
+            replaceKey = key;
+            sameKey = true;
+            break;
+        }
+        if (key == 0) {
+            if (replaceScore != INT32_MIN) {
+                replace = &slot;
+                replaceWord = word;
+                replaceKey = key;
+                replaceScore = INT32_MIN;
+            }
+            continue;
+        }
 
-    if (entry.key == 0) {
-        // Empty slot
-        shouldReplace = true;
+        TTData entry = TTData::unpack(word);
+        int ageDiff = (generation - entry.generation()) & TT_GENERATION_MASK;
+        int score = entry.depth - ageDiff;
+        if (score < replaceScore) {
+            replace = &slot;
+            replaceWord = word;
+            replaceKey = key;
+            replaceScore = score;
+        }
     }
-    else if (entry.key == zobristKey) {
-        // Same position: always allow updates for deeper or better moves
-        shouldReplace = (depth >= entry.depth);
+
+    TTData old = TTData::unpack(replaceWord);
+
+    bool shouldReplace;
+    if (sameKey) {
+        // Same position: always allow updates for deeper or better moves,
+        // and let a fresh result replace one left over from an earlier search
+        shouldReplace = (depth >= old.depth) || old.generation() != generation;
     }
     else {
-        // Different key: compare old vs new “priority score”
-        int ageDiff = currentAge - entry.age;
-        int oldScore = entry.depth - ageDiff;
-        int newScore = depth;  // fresh entry has no age penalty
-
-        shouldReplace = (newScore >= oldScore);
+        // Prevent quiescence (depth<0) from wiping out real searches
+        shouldReplace = !(depth < 0 && replaceKey != 0 && old.depth > 0);
     }
-    // --- end replacement-policy patch ---
 
     if (shouldReplace) {
-        if (entry.key == 0)       ++entriesOccupied;
-        else if (isOverwrite)     ++overwritten;
-
-        entry.key      = zobristKey;
-        entry.depth    = depth;
-        entry.eval     = eval;
-        entry.flag     = flag;
-        entry.bestMove = bestMove;
-        entry.age      = currentAge;
-        ++actualStores;
-    }
-    else if (entry.key == zobristKey && bestMove.piece != NONE) {
+        if (statsEnabled && replaceKey != 0 && !sameKey) ++ttStats.replacements;
+
+        TTData entry;
+        entry.depth      = static_cast<int8_t>(depth);
+        entry.eval       = encodeScore(eval);
+        entry.staticEval = static_cast<int16_t>(staticEval == TT_EVAL_NONE ? TT_EVAL_NONE
+                                                : std::clamp(staticEval, -TT_MAX_EVAL, TT_MAX_EVAL));
+        entry.genBound   = static_cast<uint8_t>(generation << 2 | flag);
+        entry.move       = move;
+        replace->write(zobristKey, entry.pack());
+    }
+    else if (sameKey && move != 0) {
         // still update the move if it’s a better move for same position
-        entry.bestMove = bestMove;
+        old.move = move;
+        replace->write(zobristKey, old.pack());
     }
 }
 
 
 void TranspositionTable::clear() {
-    for (size_t i = 0; i < TT_SIZE; ++i)
-    table[i] = TTEntry{};
+    auto startTime = std::chrono::steady_clock::now();
+
+    // not worth a thread for less than this many bytes
+    constexpr size_t minBytesPerThread = 16 << 20;
+    size_t bytes = numClusters * sizeof(TTCluster);
+    size_t threads = std::clamp<size_t>(bytes / minBytesPerThread, 1, std::max(clearThreads, 1));
+
+    // All zero is an empty entry. Nothing may probe or store while we clear,
+    // so the atomics can be wiped with a plain memset.
+    auto clearSlice = [this, threads](size_t index) {
+        size_t begin = numClusters * index / threads;
+        size_t end   = numClusters * (index + 1) / threads;
+        std::memset(static_cast<void*>(table + begin), 0, (end - begin) * sizeof(TTCluster));
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (size_t i = 1; i < threads; ++i)
+        workers.emplace_back(clearSlice, i);
+    clearSlice(0);
+    for (std::thread &worker : workers)
+        worker.join();
+
+    lastClearThreadsUsed = static_cast<int>(threads);
+    lastClearMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
 }
 
 size_t TranspositionTable::countOccupied() const {
     size_t count = 0;
-    for (size_t i = 0; i < TT_SIZE; ++i) {
-        if (table[i].key != 0) ++count;
+    for (size_t i = 0; i < numClusters; ++i) {
+        for (const TTEntry &slot : table[i].entries)
+            if (slot.key(slot.loadData()) != 0) ++count;
     }
     return count;
 }
 
+// Permille of entries written in the current generation, estimated from the first
+// 1000 entries. Reading a fixed sample keeps this cheap enough to call every iteration
+// and leaves store() free of any shared counter.
 int TranspositionTable::hashfull() const
 {
-    // Calculate hashfull based on the total number of occupied entries
-    if (TT_SIZE == 0) return 0; // Avoid division by zero
-    return static_cast<int>((static_cast<uint64_t>(entriesOccupied) * 1000) / TT_SIZE);
+    constexpr size_t sampleClusters = 1000 / TT_CLUSTER_SIZE;
+    size_t clusters = std::min(sampleClusters, numClusters);
+    if (clusters == 0) return 0; // Avoid division by zero
+
+    int generation = currentGeneration();
+    size_t count = 0;
+    for (size_t i = 0; i < clusters; ++i) {
+        for (const TTEntry &slot : table[i].entries) {
+            uint64_t word = slot.loadData();
+            if (slot.key(word) != 0 && TTData::unpack(word).generation() == generation)
+                ++count;
+        }
+    }
+    return static_cast<int>(count * 1000 / (clusters * TT_CLUSTER_SIZE));
 }
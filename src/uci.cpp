@@ -4,9 +4,10 @@
 #include <vector>
 #include <cstdlib> 
 #include <ctime>
-#include "board.h"
+#include <algorithm>
 #include "bitboard.h"
 #include "search.h"
+#include "tt.h"
 
 // bro why does c++ not have a built in trim function lol
 std::string trim(const std::string& s) {
@@ -16,6 +17,16 @@ std::string trim(const std::string& s) {
 }
 
 
+static void printHashInfo() {
+    std::cout << "info string Hash " << TT.sizeMB() << " MB using "
+              << TT.backingName() << "\n" << std::flush;
+}
+
+static void printClearInfo() {
+    std::cout << "info string Hash cleared in " << static_cast<int>(TT.lastClearMs) << " ms using "
+              << TT.lastClearThreadsUsed << " thread(s)\n" << std::flush;
+}
+
 void uciLoop() {
     srand(time(NULL));
     std::string line;
@@ -23,6 +34,8 @@ void uciLoop() {
 
     std::vector<std::string> lastUCIMoves;
     std::string lastFEN;
+    bool hashInfoReported = false;
+    std::string hashFile;
 
     while(std::getline(std::cin, line)) {
         std::istringstream iss(line);
@@ -32,13 +45,97 @@ void uciLoop() {
         if(token == "uci") {
             std::cout << "id name Ironfangv8\n" << std::flush;
             std::cout << "id author dark\n" << std::flush;
+            std::cout << "option name Hash type spin default " << TT_DEFAULT_MB
+                      << " min " << TT_MIN_MB << " max " << TT_MAX_MB << "\n" << std::flush;
+            std::cout << "option name Hash Threads type spin default " << TT.clearThreads
+                      << " min 1 max " << TT_MAX_CLEAR_THREADS << "\n" << std::flush;
+            std::cout << "option name TT Stats type check default false\n" << std::flush;
+            std::cout << "option name Hash File type string default <empty>\n" << std::flush;
+            std::cout << "option name Shared Hash type string default <empty>\n" << std::flush;
+            std::cout << "option name Save Hash type button\n" << std::flush;
+            std::cout << "option name Load Hash type button\n" << std::flush;
             std::cout << "uciok\n" << std::flush;
         }
+        else if(token == "debug") {
+            std::string mode;
+            iss >> mode;
+            TranspositionTable::statsEnabled = (mode == "on");
+        }
         else if(token == "isready") {
             std::cout << "readyok\n" << std::flush;
         }
+        else if(token == "setoption") {
+            // setoption name <id> [value <x>], the id itself may contain spaces
+            std::string name, value, word;
+            iss >> word; // "name"
+            while(iss >> word && word != "value") {
+                name += (name.empty() ? "" : " ") + word;
+            }
+            while(iss >> word) {
+                value += (value.empty() ? "" : " ") + word;
+            }
+
+            if(name == "Hash") {
+                try {
+                    TT.resize(std::stoul(value));
+                    printHashInfo();
+                    if(!TT.isShared()) printClearInfo();
+                    hashInfoReported = true;
+                }
+                catch (...) {
+                    std::cout << "info string Could not set Hash to " << value << "\n" << std::flush;
+                }
+            }
+            else if(name == "TT Stats") {
+                TranspositionTable::statsEnabled = (value == "true");
+            }
+            else if(name == "Hash File") {
+                hashFile = (value == "<empty>") ? "" : value;
+            }
+            else if(name == "Shared Hash") {
+                std::string error;
+                if(!TT.setShared(value == "<empty>" ? "" : value, error)) {
+                    std::cout << "info string Could not share hash: " << error << "\n" << std::flush;
+                }
+                printHashInfo();
+                hashInfoReported = true;
+            }
+            else if(name == "Save Hash" || name == "Load Hash") {
+                std::string error;
+                if(hashFile.empty()) {
+                    std::cout << "info string Set Hash File first\n" << std::flush;
+                }
+                else if(name == "Save Hash" && !TT.save(hashFile, error)) {
+                    std::cout << "info string Could not save hash: " << error << "\n" << std::flush;
+                }
+                else if(name == "Load Hash" && !TT.load(hashFile, error)) {
+                    std::cout << "info string Could not load hash: " << error << "\n" << std::flush;
+                    printHashInfo();
+                }
+                else {
+                    std::cout << "info string " << (name == "Save Hash" ? "Saved hash to " : "Loaded hash from ")
+                              << hashFile << "\n" << std::flush;
+                    printHashInfo();
+                }
+                hashInfoReported = true;
+            }
+            else if(name == "Hash Threads") {
+                // threads used to clear (and first touch) the hash, search itself is single threaded
+                try {
+                    TT.clearThreads = std::clamp(std::stoi(value), 1, TT_MAX_CLEAR_THREADS);
+                }
+                catch (...) {
+                    std::cout << "info string Could not set Hash Threads to " << value << "\n" << std::flush;
+                }
+            }
+        }
         else if(token == "ucinewgame") {
             board.setStartPosition();
+            // a shared table belongs to every attached process, leave it alone
+            if(!TT.isShared()) {
+                TT.clear();
+                printClearInfo();
+            }
         }
         else if (token == "position") {
             std::string sub;
@@ -92,7 +189,7 @@ void uciLoop() {
                     i < currentUCIMoves.size(); ++i)
                 {
                     Move m = uciToMove(currentUCIMoves[i], board);
-                    board.makeMove(m);
+                    board.makeGameMove(m);
                 }
             }
             else {
@@ -106,7 +203,7 @@ void uciLoop() {
 
                 for (const std::string &mv : currentUCIMoves) {
                     Move m = uciToMove(mv, board);
-                    board.makeMove(m);
+                    board.makeGameMove(m);
                 }
             }
 
@@ -116,6 +213,11 @@ void uciLoop() {
         }
 
         else if(token == "go") {
+            if(!hashInfoReported) {
+                printHashInfo();
+                hashInfoReported = true;
+            }
+
             int movetime = -1;
             int wtime = -1, btime = -1;
             int winc = 0, binc = 0;
@@ -162,7 +264,7 @@ void uciLoop() {
                     timeForMove = (timeLeft / movestogo) + increment;  // Removed +1 from divisor, use full increment
                 } else {
                     // Use more aggressive estimates for remaining moves
-                    uint64_t allPieces = board.getAllPieces();
+                    uint64_t allPieces = board.pieces();
                     pieceCount = __builtin_popcountll(allPieces);
                     
                     int estimatedMoves;
@@ -204,7 +306,7 @@ void uciLoop() {
                 
                 Move bestMove = Search::findBestMove(board, maxDepth, timeForMove);
                 
-                if (bestMove.from != -1) {
+                if (!bestMove.isNone()) {
                     std::cout << "bestmove " << moveToUCI(bestMove) << "\n" << std::flush;
                 }
                 else {
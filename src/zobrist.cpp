@@ -3,13 +3,13 @@
 #include <random> 
 
 uint64_t zobristPieces[12][64];
-uint64_t zobristCastling[4];
+uint64_t zobristCastling[16];
 uint64_t zobristEnPassant[8];
 uint64_t zobristBlackToMove;
 
 
 void initZobrist() {
-    std::mt19937_64 rng(1337);      // Random number generator
+    std::mt19937_64 rng(ZOBRIST_SEED);      // Random number generator
     std::uniform_int_distribution<uint64_t> dist;
 
     for(int piece = 0; piece < 12; ++piece) {
@@ -18,7 +18,7 @@ void initZobrist() {
         }
     }
 
-    for(int i = 0; i < 4; ++i) {
+    for(int i = 0; i < 16; ++i) {
         zobristCastling[i] = dist(rng);
     }
 
@@ -30,37 +30,23 @@ void initZobrist() {
 
 }
 
-uint64_t generateZobristHashKey(BitBoard &b)
+uint64_t zobristFingerprint()
 {
-    uint64_t key = 0;
-
-    for(int square = 0; square < 64; ++square) {
-        Piece p = b.getPiece(square);
-        int index = pieceToZobristIndex(p);
-
-        if(index != -1) {
-            key ^= zobristPieces[index][square];
-        }
-    }
-
-    if(b.whiteKingsideCastle) key ^= zobristCastling[0];
-    if(b.whiteQueensideCastle) key ^= zobristCastling[1];
-    if(b.blackKingsideCastle) key ^= zobristCastling[2];
-    if(b.blackQueensideCastle) key ^= zobristCastling[3];
-
-    if(b.enPassantSquare != -1) {
-        int file = b.enPassantSquare % 8;
-        key ^= zobristEnPassant[file];
-    }
-
-    if(b.sideToMove == BLACK) {
-        key ^= zobristBlackToMove;
-    }
-
-    return key;
+    uint64_t fingerprint = ZOBRIST_SEED;
+    auto fold = [&fingerprint](uint64_t key) {
+        fingerprint = (fingerprint ^ key) * 0x100000001b3ULL;
+    };
+
+    for(auto &piece : zobristPieces)
+        for(uint64_t key : piece) fold(key);
+    for(uint64_t key : zobristCastling) fold(key);
+    for(uint64_t key : zobristEnPassant) fold(key);
+    fold(zobristBlackToMove);
+
+    return fingerprint;
 }
 
-uint64_t generateZobristHashKey(Board &b)
+uint64_t generateZobristHashKey(BitBoard &b)
 {
     uint64_t key = 0;
 
@@ -73,10 +59,7 @@ uint64_t generateZobristHashKey(Board &b)
         }
     }
 
-    if(b.whiteKingsideCastle) key ^= zobristCastling[0];
-    if(b.whiteQueensideCastle) key ^= zobristCastling[1];
-    if(b.blackKingsideCastle) key ^= zobristCastling[2];
-    if(b.blackQueensideCastle) key ^= zobristCastling[3];
+    key ^= zobristCastling[b.castlingRights];
 
     if(b.enPassantSquare != -1) {
         int file = b.enPassantSquare % 8;
@@ -88,4 +71,4 @@ uint64_t generateZobristHashKey(Board &b)
     }
 
     return key;
-}
\ No newline at end of file
+}